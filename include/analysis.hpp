@@ -0,0 +1,24 @@
+#ifndef _ANALYSIS_HPP
+#define _ANALYSIS_HPP
+
+#include <cstdint>
+
+#include "board.hpp"
+#include "game.hpp"
+
+inline constexpr uint8_t unreachable_distance = UINT8_MAX;
+
+// Road tiles still to come, the drawn tile and the draw pile
+uint8_t count_roads_left(const Game &game);
+
+// Fewest road tiles that still have to be placed to join the start and finish
+// tiles, found with a 0-1 BFS where placed roads are free and empty tiles cost
+// one. Returns unreachable_distance when dragons cut every path.
+uint8_t min_roads_to_finish(const Board &board);
+
+// True when the remaining road tiles can't finish the road anymore, no
+// matter where they are placed. Dragons only make things worse, so a doomed
+// game stays doomed.
+bool is_doomed(const Game &game);
+
+#endif // _ANALYSIS_HPP
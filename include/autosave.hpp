@@ -0,0 +1,62 @@
+#ifndef _AUTOSAVE_HPP
+#define _AUTOSAVE_HPP
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <stop_token>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "board.hpp"
+#include "game.hpp"
+#include "random.hpp"
+#include "triple_buffer.hpp"
+
+// Everything needed to carry on with a game: the board, the draw pile in
+// order, the drawn tile, the rng for dragon rolls and the game log
+struct SaveState {
+  std::array<uint8_t, Board::m_board_size> m_tiles{};
+  std::vector<uint8_t> m_pile;
+  uint8_t m_next_tile{0};
+  uint8_t m_eq_count{0};
+  uint8_t m_flags{0};
+  Rng m_rng{};
+  std::vector<std::string> m_log;
+
+  void capture(const Game &game, const std::vector<std::string> &log);
+  void restore(Game &game, std::vector<std::string> &log) const;
+  bool is_finished() const;
+};
+
+// Writes the latest state handed over on a thread of its own. Handing over
+// only fills and publishes a slot of a triple buffer, so the caller never
+// waits on the disk, and states that come faster than they can be written
+// are skipped. Files are written to a temporary name, synced and renamed
+// over the old one, so a crash leaves either the old or the new save.
+class Autosave {
+  std::string m_path;
+  TripleBuffer<SaveState> m_states;
+  std::atomic<uint32_t> m_wake{0};
+  std::jthread m_thread;
+
+public:
+  explicit Autosave(const char *path);
+  // Writes the last state handed over before returning
+  ~Autosave();
+  Autosave(const Autosave &) = delete;
+  Autosave &operator=(const Autosave &) = delete;
+
+  // Single producer, fill the state returned by next() and submit() it
+  SaveState &next() { return m_states.back(); }
+  void submit();
+
+  static bool load(const char *path, SaveState &out);
+
+private:
+  void run(std::stop_token stop);
+  bool write(const SaveState &state) const;
+};
+
+#endif // _AUTOSAVE_HPP
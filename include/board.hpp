@@ -8,8 +8,11 @@
 #include <cstdint>
 #include <vector>
 
+#include "random.hpp"
 #include "tile.hpp"
 
+class GeometryBatch;
+
 class Board {
 public:
   static constexpr uint8_t m_board_width = 6;
@@ -18,7 +21,6 @@ public:
   float m_tile_width{};
   float m_tile_height{};
   std::vector<Tile> m_draw_pile;
-  Tile *m_selected_tile{nullptr};
   SDL_FPoint m_position{};
   SDL_FRect m_board_rect{};
   std::vector<SDL_Point> m_valid_moves;
@@ -34,16 +36,22 @@ private:
   int m_end_tiles_count{0};
   SDL_FRect m_exit_arrow{};
 
+  void update_tile_rects();
+
 public:
   void init(int res_x, int res_y);
-  void randomize_draw_pile();
+  void init(const SDL_FRect &viewport);
+  void randomize_draw_pile(Rng &rng);
   Tile &get_tile(uint8_t x, uint8_t y);
-  void set_selected(uint8_t x, uint8_t y);
-  void unselect();
-  void render(SDL_Renderer *r);
+  const Tile &get_tile(uint8_t x, uint8_t y) const;
+  void render(SDL_Renderer *r) const;
+  // Hover highlight, kept out of the board so snapshots of it stay immutable
+  void render_selection(SDL_Renderer *r, uint8_t x, uint8_t y) const;
+  void render(GeometryBatch &batch) const;
   void add_valid_moves_from_tile(const int x, const int y);
   void update_valid_moves();
-  void new_game();
+  void rebuild_valid_moves();
+  void new_game(Rng &rng);
   void recalculate_reachable_tiles();
   void recalculate_end_tiles();
   bool can_reach_end();
@@ -0,0 +1,90 @@
+#ifndef _DRAGONS_ENV_H
+#define _DRAGONS_ENV_H
+
+/*
+ * C ABI for stepping many independent games at once, e.g. from a training
+ * loop. All buffers are owned by the caller and written in place, every
+ * array is indexed by environment first.
+ *
+ * Observation of one environment, DA_OBS_SIZE bytes, each value 0 or 1
+ * unless stated otherwise:
+ *   DA_PLANE_COUNT planes of DA_CELL_COUNT cells in row major order
+ *     (y * DA_BOARD_WIDTH + x), see DA_PLANE_* for their meaning
+ *   next tile type one-hot (none, equipment, dragon, road)
+ *   next tile road connections (up, right, down, left)
+ *   knights equipment pieces held (count)
+ *   road tiles left in the draw pile (count)
+ *   dragon tiles left in the draw pile (count)
+ *
+ * Action is (y * DA_BOARD_WIDTH + x) * 4 + rotation, where rotation is the
+ * number of clockwise quarter turns applied to the drawn tile. Illegal
+ * actions leave the game unchanged and give DA_REWARD_ILLEGAL, the action
+ * mask (DA_ACTION_COUNT bytes per environment) lists the legal ones.
+ *
+ * Finished games report done and the terminal reward, then restart on their
+ * own so the observation written in the same step is the first one of the
+ * next game.
+ */
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define DA_BOARD_WIDTH 6
+#define DA_BOARD_HEIGHT 8
+#define DA_CELL_COUNT (DA_BOARD_WIDTH * DA_BOARD_HEIGHT)
+
+#define DA_PLANE_EMPTY 0
+#define DA_PLANE_EQUIPMENT 1
+#define DA_PLANE_DRAGON 2
+#define DA_PLANE_ROAD 3
+#define DA_PLANE_ROAD_UP 4
+#define DA_PLANE_ROAD_RIGHT 5
+#define DA_PLANE_ROAD_DOWN 6
+#define DA_PLANE_ROAD_LEFT 7
+#define DA_PLANE_VALID_MOVE 8
+#define DA_PLANE_COUNT 9
+
+#define DA_OBS_NEXT_TILE_TYPE (DA_PLANE_COUNT * DA_CELL_COUNT)
+#define DA_OBS_NEXT_TILE_ROAD (DA_OBS_NEXT_TILE_TYPE + 4)
+#define DA_OBS_EQUIPMENT_COUNT (DA_OBS_NEXT_TILE_ROAD + 4)
+#define DA_OBS_PILE_ROADS (DA_OBS_EQUIPMENT_COUNT + 1)
+#define DA_OBS_PILE_DRAGONS (DA_OBS_PILE_ROADS + 1)
+#define DA_OBS_SIZE (DA_OBS_PILE_DRAGONS + 1)
+
+#define DA_ACTION_COUNT (DA_CELL_COUNT * 4)
+
+#define DA_REWARD_WIN 1.0f
+#define DA_REWARD_LOSS -1.0f
+#define DA_REWARD_ILLEGAL -0.1f
+
+typedef struct da_env_batch da_env_batch;
+
+/*
+ * Creates count games, game i is seeded from seed and i. thread_count 0 uses
+ * one thread per core. Returns NULL on failure.
+ */
+da_env_batch *da_env_batch_create(uint32_t count, uint64_t seed,
+                                  uint32_t thread_count);
+void da_env_batch_destroy(da_env_batch *batch);
+uint32_t da_env_batch_size(const da_env_batch *batch);
+
+/* Starts a new game in every environment. action_mask may be NULL. */
+void da_env_batch_reset(da_env_batch *batch, uint8_t *obs,
+                        uint8_t *action_mask);
+
+/*
+ * Plays actions[i] in game i. obs, rewards and dones are required,
+ * action_mask may be NULL.
+ */
+void da_env_batch_step(da_env_batch *batch, const uint32_t *actions,
+                       uint8_t *obs, uint8_t *action_mask, float *rewards,
+                       uint8_t *dones);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _DRAGONS_ENV_H */
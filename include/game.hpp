@@ -0,0 +1,58 @@
+#ifndef _GAME_HPP
+#define _GAME_HPP
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+#include "board.hpp"
+#include "random.hpp"
+#include "tile.hpp"
+
+// Tile placement, rotation is the number of clockwise quarter turns applied to
+// the drawn tile before it is put on the board
+struct Placement {
+  uint8_t x{0};
+  uint8_t y{0};
+  uint8_t rotation{0};
+};
+
+// Turn logic shared by the SDL frontend and headless users, no rendering or
+// window state lives here
+struct Game {
+  static constexpr size_t m_max_placements = Board::m_board_size * 4;
+  using Placements = std::array<Placement, m_max_placements>;
+
+  Board board{};
+  Rng m_rng{};
+  Tile m_next_tile;
+  uint8_t m_eq_count{0};
+  bool m_game_over{false};
+  bool m_game_won{false};
+  // Optional sink for game messages, headless games leave it empty. The
+  // context is passed back on every call.
+  void (*m_log)(void *context, const char *message){nullptr};
+  void *m_log_context{nullptr};
+
+  void new_game();
+  bool is_move_valid(uint8_t x, uint8_t y) const;
+  bool is_placement_valid(const Tile &tile, uint8_t x, uint8_t y) const;
+  size_t legal_placements(Placements &out) const;
+  bool place_next_tile(uint8_t x, uint8_t y);
+  bool land_dragon(uint8_t x, uint8_t y);
+  void resolve_dragons();
+  void finish_turn();
+  // Places the drawn tile as it's rotated now and plays out the rest of the
+  // turn, the same for clicks and bots
+  bool take_turn(uint8_t x, uint8_t y);
+  bool play(const Placement &placement);
+  // Copies the game into out and only places the drawn tile there, the
+  // position a legal placement leads to before any dragon is rolled
+  void after_placement(const Placement &placement, Game &out) const;
+  bool is_finished() const { return m_game_over || m_game_won; }
+
+private:
+  bool draw_next_tile();
+};
+
+#endif // _GAME_HPP
@@ -0,0 +1,97 @@
+#ifndef _GAME_THREAD_HPP
+#define _GAME_THREAD_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <stop_token>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "autosave.hpp"
+#include "board.hpp"
+#include "game.hpp"
+#include "replay.hpp"
+#include "spsc_queue.hpp"
+#include "tile.hpp"
+#include "triple_buffer.hpp"
+
+// Everything a frame draws, filled in by the logic thread and read only by
+// the render thread once published
+struct GameSnapshot {
+  Board board;
+  Tile m_next_tile;
+  bool m_game_over{false};
+  bool m_game_won{false};
+  std::vector<std::string> m_log;
+  // SDL timestamp of the newest input applied to this state
+  uint64_t m_input_ns{0};
+
+  void capture(const Game &game);
+};
+
+enum struct CommandType : uint8_t { Place, Rotate, NewGame };
+
+struct Command {
+  CommandType m_type{CommandType::Place};
+  uint8_t m_x{0};
+  uint8_t m_y{0};
+  uint64_t m_timestamp_ns{0};
+};
+
+// Runs the rules for one game on a thread of its own. The main thread pushes
+// commands and draws the latest published snapshot, so neither rules work
+// nor replay saving can hold up a frame and waiting on vsync can't hold up
+// the rules.
+class GameThread {
+public:
+  static constexpr size_t m_queue_size = 64;
+  static constexpr const char *m_replay_path = "last_game.replay";
+  static constexpr const char *m_save_path = "session.save";
+  // Older lines scroll off, which keeps copying the log into every
+  // snapshot and save cheap
+  static constexpr size_t m_max_log_lines = 32;
+
+private:
+  Game m_game;
+  Replay m_replay;
+  std::vector<std::string> m_log;
+  uint64_t m_input_ns{0};
+  TripleBuffer<GameSnapshot> m_snapshots;
+
+  // The main thread pushes, the logic thread drains
+  SpscQueue<Command, m_queue_size> m_queue;
+  // Bumped on every push and on shutdown, the logic thread sleeps on it
+  std::atomic<uint32_t> m_wake{0};
+
+  // Outlives the logic thread so its last state still gets written
+  Autosave m_autosave{m_save_path};
+  std::jthread m_thread;
+
+public:
+  // setup carries the board layout, drawn tile rect and seeded rng. An
+  // unfinished game left in the autosave is picked up instead of dealing.
+  explicit GameThread(const Game &setup);
+  ~GameThread();
+  GameThread(const GameThread &) = delete;
+  GameThread &operator=(const GameThread &) = delete;
+
+  // Main thread only. Returns false and drops the command if the logic
+  // thread is that far behind.
+  bool push(const Command &command);
+  // Main thread only, see TripleBuffer
+  bool acquire() { return m_snapshots.acquire(); }
+  const GameSnapshot &snapshot() const { return m_snapshots.front(); }
+
+private:
+  void run(std::stop_token stop);
+  void apply(const Command &command);
+  static void log_message(void *context, const char *message);
+  void trim_log();
+  void new_game();
+  void publish();
+  void save();
+};
+
+#endif // _GAME_THREAD_HPP
@@ -0,0 +1,24 @@
+#ifndef _GEOMETRY_BATCH_HPP
+#define _GEOMETRY_BATCH_HPP
+
+#include <SDL3/SDL_pixels.h>
+#include <SDL3/SDL_rect.h>
+#include <SDL3/SDL_render.h>
+
+#include <vector>
+
+// Collects solid rectangles and submits them with one SDL_RenderGeometry call
+class GeometryBatch {
+private:
+  std::vector<SDL_Vertex> m_vertices;
+  std::vector<int> m_indices;
+
+public:
+  void clear();
+  void add_rect(const SDL_FRect &rect, const SDL_Color &color);
+  void add_outline(const SDL_FRect &rect, float thickness,
+                   const SDL_Color &color);
+  void draw(SDL_Renderer *r) const;
+};
+
+#endif // _GEOMETRY_BATCH_HPP
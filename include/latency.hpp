@@ -0,0 +1,33 @@
+#ifndef _LATENCY_HPP
+#define _LATENCY_HPP
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+// Measures the time between an input event being timestamped by SDL and the
+// first SDL_RenderPresent() that follows it.
+class LatencyTracker {
+public:
+  static constexpr size_t m_max_pending = 256;
+  static constexpr size_t m_max_samples = 4096;
+  uint64_t m_frame_budget_ns{16'666'667};
+
+private:
+  std::array<uint64_t, m_max_pending> m_pending;
+  size_t m_pending_count{0};
+  std::array<uint64_t, m_max_samples> m_samples;
+  size_t m_sample_count{0};
+  size_t m_next_sample{0};
+  uint64_t m_total_count{0};
+  uint64_t m_over_budget_count{0};
+
+public:
+  void set_refresh_rate(float hz);
+  void input(uint64_t timestamp_ns);
+  void presented(uint64_t now_ns);
+  uint64_t percentile(float p) const;
+  void report() const;
+};
+
+#endif // _LATENCY_HPP
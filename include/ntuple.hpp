@@ -0,0 +1,48 @@
+#ifndef _NTUPLE_HPP
+#define _NTUPLE_HPP
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "board.hpp"
+#include "game.hpp"
+#include "random.hpp"
+
+// Static position evaluator made of lookup tables. Every 2x2 window of the
+// board indexes a table by the four tiles in it, every run of four cells in
+// a row or column indexes one by how its tiles connect along the run, and
+// small tables cover the equipment count, what's left in the draw pile and
+// the drawn tile. The summed weights are squashed into a chance to win.
+class NTupleEvaluator {
+public:
+  static constexpr size_t m_square_count =
+      (Board::m_board_width - 1) * (Board::m_board_height - 1);
+  static constexpr size_t m_line_count =
+      ((Board::m_board_width - 3) * Board::m_board_height) +
+      (Board::m_board_width * (Board::m_board_height - 3));
+  static constexpr size_t m_feature_count = m_square_count + m_line_count + 3;
+  // One weight index per table
+  using Features = std::array<uint32_t, m_feature_count>;
+
+private:
+  std::vector<float> m_weights;
+
+public:
+  NTupleEvaluator();
+
+  static void features(const Game &game, Features &out);
+  float evaluate(const Features &features) const;
+  float evaluate(const Game &game) const;
+  // Moves the estimate for features towards target, a win is 1, a loss 0
+  void train(const Features &features, float target, float rate);
+  // Placement whose position scores best before dragons are rolled, same
+  // contract as a Policy
+  bool best_placement(const Game &game, Rng &rng, Placement &out) const;
+
+  bool save(const char *path) const;
+  bool load(const char *path);
+};
+
+#endif // _NTUPLE_HPP
@@ -0,0 +1,19 @@
+#ifndef _POLICY_HPP
+#define _POLICY_HPP
+
+#include "game.hpp"
+#include "random.hpp"
+
+// Picks a placement for the drawn tile, returns false when there is none
+using Policy = bool (*)(const Game &game, Rng &rng, Placement &out);
+
+bool random_policy(const Game &game, Rng &rng, Placement &out);
+// Takes the placement that leaves the fewest roads still needed to finish,
+// ties are broken at random
+bool greedy_policy(const Game &game, Rng &rng, Placement &out);
+
+// Headless game loop, plays game to the end with policy and returns true
+// when it was won
+bool play_game(Game &game, Policy policy, Rng &rng);
+
+#endif // _POLICY_HPP
@@ -0,0 +1,14 @@
+#ifndef _RANDOM_HPP
+#define _RANDOM_HPP
+
+#include <random>
+
+// Small engine so a game can carry its own generator and stay cheap to copy
+using Rng = std::minstd_rand;
+
+// Rolls a six sided die, result is in range 0-5
+inline int get_random(Rng &rng) {
+  return std::uniform_int_distribution<>(0, 5)(rng);
+}
+
+#endif // _RANDOM_HPP
@@ -0,0 +1,65 @@
+#ifndef _REPLAY_HPP
+#define _REPLAY_HPP
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "board.hpp"
+#include "game.hpp"
+
+// Recorded game, one entry per turn. Every turn is kept as the tiles that
+// changed, every m_keyframe_interval turns a full snapshot is kept as well,
+// so seeking to any turn applies at most that many deltas.
+class Replay {
+public:
+  static constexpr size_t m_keyframe_interval = 64;
+
+private:
+  struct Snapshot {
+    std::array<uint8_t, Board::m_board_size> m_tiles{};
+    uint8_t m_next_tile{0};
+    uint8_t m_eq_count{0};
+    uint8_t m_flags{0};
+    uint8_t m_pile_size{0};
+  };
+
+  struct Change {
+    uint8_t m_cell{0};
+    uint8_t m_tile{0};
+  };
+
+  struct Delta {
+    uint32_t m_first_change{0};
+    uint32_t m_change_count{0};
+    uint8_t m_next_tile{0};
+    uint8_t m_eq_count{0};
+    uint8_t m_flags{0};
+    uint8_t m_pile_size{0};
+  };
+
+  std::vector<Snapshot> m_keyframes;
+  std::vector<Delta> m_deltas;
+  std::vector<Change> m_changes;
+  Snapshot m_last{};
+
+public:
+  void clear();
+  // Appends the state of the game as the next turn, the first call after
+  // clear() stores the starting position
+  void record(const Game &game);
+  size_t turn_count() const { return m_deltas.size(); }
+  // Puts the board, drawn tile, equipment and result of the given turn into
+  // game. The draw pile is left alone, only its size is recorded.
+  void seek(size_t turn, Game &game) const;
+
+  bool save(const char *path) const;
+  bool load(const char *path);
+
+private:
+  static Snapshot capture(const Game &game);
+  void apply(const Delta &delta, Snapshot &snapshot) const;
+};
+
+#endif // _REPLAY_HPP
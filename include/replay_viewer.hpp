@@ -0,0 +1,41 @@
+#ifndef _REPLAY_VIEWER_HPP
+#define _REPLAY_VIEWER_HPP
+
+#include <SDL3/SDL_events.h>
+#include <SDL3/SDL_rect.h>
+#include <SDL3/SDL_render.h>
+
+#include <cstddef>
+#include <cstdint>
+
+#include "game.hpp"
+#include "replay.hpp"
+
+// Playback controls for a Replay. The viewer only swaps the state of the
+// game it's given, drawing the board is left to the normal render path.
+class ReplayViewer {
+public:
+  static constexpr double m_min_speed = 1.0;
+  static constexpr double m_max_speed = 16384.0;
+  Replay m_replay;
+  SDL_FRect m_timeline{};
+  double m_position{0.0};
+  double m_speed{4.0}; // turns per second
+  bool m_playing{false};
+
+private:
+  bool m_dragging{false};
+  size_t m_shown_turn{SIZE_MAX};
+
+public:
+  void handle_event(const SDL_Event &event);
+  void update(Game &game, double elapsed_seconds);
+  void render(SDL_Renderer *r) const;
+  size_t turn() const { return static_cast<size_t>(m_position); }
+
+private:
+  void seek(double position);
+  void seek_to_pointer(float x);
+};
+
+#endif // _REPLAY_VIEWER_HPP
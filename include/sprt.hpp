@@ -0,0 +1,38 @@
+#ifndef _SPRT_HPP
+#define _SPRT_HPP
+
+#include <cmath>
+
+enum struct Verdict { Undecided, AcceptH0, AcceptH1 };
+
+// Sequential probability ratio test on split pairs, the ones only one side
+// won. H0 is that A wins half of them, H1 that A wins p1 of them. alpha and
+// beta are the accepted rates of false H1 and false H0 verdicts.
+class Sprt {
+  double m_a_only;
+  double m_b_only;
+  double m_lower;
+  double m_upper;
+  double m_llr{0.0};
+
+public:
+  Sprt(double p1, double alpha, double beta)
+      : m_a_only{std::log(p1 / 0.5)}, m_b_only{std::log((1.0 - p1) / 0.5)},
+        m_lower{std::log(beta / (1.0 - alpha))},
+        m_upper{std::log((1.0 - beta) / alpha)} {}
+
+  Verdict add(bool a_won) {
+    m_llr += a_won ? m_a_only : m_b_only;
+    if (m_llr >= m_upper)
+      return Verdict::AcceptH1;
+    if (m_llr <= m_lower)
+      return Verdict::AcceptH0;
+    return Verdict::Undecided;
+  }
+
+  double llr() const { return m_llr; }
+  double lower() const { return m_lower; }
+  double upper() const { return m_upper; }
+};
+
+#endif // _SPRT_HPP
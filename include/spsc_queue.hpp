@@ -0,0 +1,40 @@
+#ifndef _SPSC_QUEUE_HPP
+#define _SPSC_QUEUE_HPP
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+
+// Fixed size ring for one producer thread and one consumer thread. The
+// producer only moves the tail and the consumer only moves the head, so
+// neither side takes a lock.
+template <typename T, size_t N> class SpscQueue {
+  std::array<T, N> m_items{};
+  alignas(64) std::atomic<size_t> m_head{0};
+  alignas(64) std::atomic<size_t> m_tail{0};
+
+public:
+  // Producer side, returns false and drops the item when the queue is full
+  bool push(const T &item) {
+    const auto tail = m_tail.load(std::memory_order_relaxed);
+    if ((tail - m_head.load(std::memory_order_acquire)) >= N)
+      return false;
+
+    m_items.at(tail % N) = item;
+    m_tail.store(tail + 1, std::memory_order_release);
+    return true;
+  }
+
+  // Consumer side, calls f on every item pushed so far in order and returns
+  // how many there were
+  template <typename F> size_t drain(F &&f) {
+    const auto head = m_head.load(std::memory_order_relaxed);
+    const auto tail = m_tail.load(std::memory_order_acquire);
+    for (auto i{head}; i != tail; ++i)
+      f(m_items.at(i % N));
+    m_head.store(tail, std::memory_order_release);
+    return tail - head;
+  }
+};
+
+#endif // _SPSC_QUEUE_HPP
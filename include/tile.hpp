@@ -6,6 +6,8 @@
 
 #include <cstdint>
 
+class GeometryBatch;
+
 enum struct TileType { None = 0, Equipment, Dragon, Road };
 
 enum struct RoadConnections : uint8_t {
@@ -18,12 +20,15 @@ enum struct RoadConnections : uint8_t {
 struct Tile {
   TileType m_type{TileType::None};
   uint8_t m_road_connections{0};
-  bool m_selected{false};
   SDL_FRect m_rect{};
 
   bool has_road_connection(const RoadConnections &con) const;
   void render(SDL_Renderer *r) const;
+  void render(GeometryBatch &batch) const;
   void rotate();
+  // Type and road connections in one byte, layout is kept as it is
+  uint8_t packed() const;
+  void set_packed(uint8_t packed);
 };
 
 #endif // _TILE_HPP
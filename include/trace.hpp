@@ -0,0 +1,44 @@
+#ifndef _TRACE_HPP
+#define _TRACE_HPP
+
+#include <cstdint>
+
+// Scoped timing zones, enabled with the DRAGONS_TRACE build option. Every
+// thread records into its own fixed buffer without locking, once a buffer is
+// full further zones of that thread are dropped. With tracing disabled the
+// macros expand to nothing and the functions below do nothing.
+
+#ifdef DRAGONS_TRACE
+
+class TraceZone {
+private:
+  const char *m_name;
+  uint64_t m_start_ns;
+
+public:
+  explicit TraceZone(const char *name);
+  ~TraceZone();
+  TraceZone(const TraceZone &) = delete;
+  TraceZone &operator=(const TraceZone &) = delete;
+};
+
+#define TRACE_CONCAT_IMPL(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_IMPL(a, b)
+// name has to be a string literal, only the pointer is stored
+#define TRACE_ZONE(name) TraceZone TRACE_CONCAT(trace_zone_, __LINE__){name}
+
+#else
+
+#define TRACE_ZONE(name)
+
+#endif // DRAGONS_TRACE
+
+// Label shown for the calling thread in the trace viewer
+void trace_set_thread_name(const char *name);
+
+// Writes every zone recorded so far in Chrome trace event format, which
+// chrome://tracing and Perfetto load directly. Safe to call while other
+// threads keep recording.
+bool trace_write_json(const char *path);
+
+#endif // _TRACE_HPP
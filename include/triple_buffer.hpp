@@ -0,0 +1,46 @@
+#ifndef _TRIPLE_BUFFER_HPP
+#define _TRIPLE_BUFFER_HPP
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+// Hands whole values from one writer thread to one reader thread without
+// locks. The writer fills back() and publishes it, the reader picks up the
+// newest published value with acquire() and reads it through front(). Both
+// sides own a slot of their own and only swap indices through the middle
+// one, so neither ever waits or sees a half written value. Values the reader
+// didn't get to in time are overwritten.
+template <typename T> class TripleBuffer {
+  static constexpr uint8_t m_index_mask = 0x3;
+  // Set on the middle index while it holds a value the reader hasn't taken
+  static constexpr uint8_t m_fresh = 0x4;
+
+  std::array<T, 3> m_slots{};
+  alignas(64) std::atomic<uint8_t> m_middle{1};
+  alignas(64) uint8_t m_back{0};
+  alignas(64) uint8_t m_front{2};
+
+public:
+  // Writer side. The slot handed out may hold an older value, the writer
+  // has to fill in all of it before publishing.
+  T &back() { return m_slots.at(m_back); }
+  void publish() {
+    const auto old = m_middle.exchange(m_back | m_fresh,
+                                       std::memory_order_acq_rel);
+    m_back = old & m_index_mask;
+  }
+
+  // Reader side, returns false and keeps the current front if nothing new
+  // was published since the last call
+  bool acquire() {
+    if (!(m_middle.load(std::memory_order_relaxed) & m_fresh))
+      return false;
+    const auto old = m_middle.exchange(m_front, std::memory_order_acq_rel);
+    m_front = old & m_index_mask;
+    return true;
+  }
+  const T &front() const { return m_slots.at(m_front); }
+};
+
+#endif // _TRIPLE_BUFFER_HPP
@@ -0,0 +1,11 @@
+#ifndef _WALL_HPP
+#define _WALL_HPP
+
+#include <SDL3/SDL_render.h>
+
+// Spectator mode, plays game_count games with a bot and draws all of them in
+// one window until it's closed
+int run_wall(SDL_Renderer *r, int res_x, int res_y, int game_count,
+             float moves_per_second);
+
+#endif // _WALL_HPP
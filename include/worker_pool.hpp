@@ -0,0 +1,56 @@
+#ifndef _WORKER_POOL_HPP
+#define _WORKER_POOL_HPP
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Fork-join pool for splitting a range of independent items across cores.
+// Threads are started once, run() itself doesn't allocate.
+class WorkerPool {
+public:
+  using Job = void (*)(void *context, size_t begin, size_t end);
+
+private:
+  std::vector<std::thread> m_threads;
+  std::mutex m_mutex;
+  std::condition_variable m_start;
+  std::condition_variable m_done;
+  uint64_t m_generation{0};
+  unsigned m_active{0};
+  bool m_stopping{false};
+
+  Job m_job{nullptr};
+  void *m_context{nullptr};
+  size_t m_count{0};
+  size_t m_chunk{1};
+  std::atomic<size_t> m_next{0};
+
+public:
+  // 0 picks one thread per core, the calling thread is counted as one of them
+  explicit WorkerPool(unsigned thread_count = 0);
+  ~WorkerPool();
+  WorkerPool(const WorkerPool &) = delete;
+  WorkerPool &operator=(const WorkerPool &) = delete;
+
+  unsigned size() const { return m_threads.size() + 1; }
+  void run(size_t count, size_t chunk, Job job, void *context);
+
+  template <typename F> void parallel_for(size_t count, size_t chunk, F &f) {
+    run(count, chunk,
+        [](void *context, size_t begin, size_t end) {
+          (*static_cast<F *>(context))(begin, end);
+        },
+        &f);
+  }
+
+private:
+  void worker_loop();
+  void work();
+};
+
+#endif // _WORKER_POOL_HPP
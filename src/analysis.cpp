@@ -0,0 +1,123 @@
+#include <array>
+#include <cstdint>
+
+#include "analysis.hpp"
+#include "board.hpp"
+#include "game.hpp"
+#include "tile.hpp"
+#include "trace.hpp"
+
+namespace {
+// Directions in RoadConnections bit order: up, right, down, left
+constexpr std::array<int, 4> dir_x{0, 1, 0, -1};
+constexpr std::array<int, 4> dir_y{-1, 0, 1, 0};
+constexpr int opposite(int dir) { return (dir + 2) % 4; }
+
+// Double ended queue for the 0-1 BFS. A tile is queued at most twice, once
+// with distance d + 1 and once after being lowered to d.
+struct CellDeque {
+  std::array<uint8_t, (2 * Board::m_board_size) + 1> m_items;
+  size_t m_head{0};
+  size_t m_tail{0};
+
+  bool empty() const { return m_head == m_tail; }
+  uint8_t pop_front() {
+    const auto cell = m_items.at(m_head);
+    m_head = (m_head + 1) % m_items.size();
+    return cell;
+  }
+  void push_front(uint8_t cell) {
+    m_head = (m_head + m_items.size() - 1) % m_items.size();
+    m_items.at(m_head) = cell;
+  }
+  void push_back(uint8_t cell) {
+    m_items.at(m_tail) = cell;
+    m_tail = (m_tail + 1) % m_items.size();
+  }
+};
+
+bool is_open(const Tile &tile) {
+  return (tile.m_type == TileType::None) ||
+         (tile.m_type == TileType::Equipment);
+}
+
+bool points_to(const Tile &tile, int dir) {
+  return tile.has_road_connection(static_cast<RoadConnections>(1 << dir));
+}
+} // namespace
+
+uint8_t count_roads_left(const Game &game) {
+  uint8_t roads = game.m_next_tile.m_type == TileType::Road ? 1 : 0;
+  for (auto &tile : game.board.m_draw_pile) {
+    if (tile.m_type == TileType::Road)
+      roads++;
+  }
+  return roads;
+}
+
+uint8_t min_roads_to_finish(const Board &board) {
+  TRACE_ZONE("min_roads_to_finish");
+
+  std::array<uint8_t, Board::m_board_size> distance;
+  distance.fill(unreachable_distance);
+
+  const auto &start = board.m_start_tile;
+  const auto &finish = board.m_finish_tile;
+  const uint8_t start_cell = (start.y * Board::m_board_width) + start.x;
+  const uint8_t finish_cell = (finish.y * Board::m_board_width) + finish.x;
+
+  const auto &start_tile = board.get_tile(start.x, start.y);
+  if (start_tile.m_type == TileType::Dragon)
+    return unreachable_distance;
+
+  CellDeque queue;
+  distance.at(start_cell) = is_open(start_tile) ? 1 : 0;
+  queue.push_back(start_cell);
+
+  while (!queue.empty()) {
+    const auto cell = queue.pop_front();
+    if (cell == finish_cell)
+      break;
+
+    const int x = cell % Board::m_board_width;
+    const int y = cell / Board::m_board_width;
+    const auto &tile = board.get_tile(x, y);
+
+    for (int dir{0}; dir < 4; ++dir) {
+      const int nx = x + dir_x.at(dir);
+      const int ny = y + dir_y.at(dir);
+      if ((nx < 0) || (nx >= Board::m_board_width) || (ny < 0) ||
+          (ny >= Board::m_board_height))
+        continue;
+
+      const auto &next = board.get_tile(nx, ny);
+      if (next.m_type == TileType::Dragon)
+        continue;
+
+      // The win check follows a connection from either side, and any tile
+      // placed on an empty spot can be turned to point at its neighbour.
+      // Only two placed roads facing away from each other are not joined.
+      if ((tile.m_type == TileType::Road) && (next.m_type == TileType::Road) &&
+          !points_to(tile, dir) && !points_to(next, opposite(dir)))
+        continue;
+
+      const uint8_t step = is_open(next) ? 1 : 0;
+      const uint8_t next_cell = (ny * Board::m_board_width) + nx;
+      if (distance.at(cell) + step < distance.at(next_cell)) {
+        distance.at(next_cell) = distance.at(cell) + step;
+        if (step == 0)
+          queue.push_front(next_cell);
+        else
+          queue.push_back(next_cell);
+      }
+    }
+  }
+
+  return distance.at(finish_cell);
+}
+
+bool is_doomed(const Game &game) {
+  // The win check follows one way connections, so every road tile, the dead
+  // end included, can stand anywhere on the road and counts the same
+  return min_roads_to_finish(game.board) > count_roads_left(game);
+}
@@ -0,0 +1,283 @@
+#include <SDL3/SDL_log.h>
+
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <sstream>
+#include <string>
+#include <system_error>
+#include <utility>
+#include <vector>
+
+#include "autosave.hpp"
+#include "board.hpp"
+#include "game.hpp"
+#include "tile.hpp"
+#include "trace.hpp"
+
+namespace {
+// File layout, native byte order: magic, version, rng state, board tiles,
+// drawn tile, equipment count, flags, pile size and tiles, then the log as
+// a line count and length prefixed lines
+constexpr char save_magic[4] = {'D', 'A', 'S', 'V'};
+constexpr uint32_t save_version = 1;
+constexpr size_t max_log_lines = 1024;
+constexpr size_t max_log_line = 1024;
+
+constexpr uint8_t flag_won = 1 << 0;
+constexpr uint8_t flag_over = 1 << 1;
+
+template <typename T> void put(std::vector<uint8_t> &bytes, const T &value) {
+  const auto *data = reinterpret_cast<const uint8_t *>(&value);
+  bytes.insert(bytes.end(), data, data + sizeof(T));
+}
+
+void put(std::vector<uint8_t> &bytes, const void *data, size_t size) {
+  const auto *begin = static_cast<const uint8_t *>(data);
+  bytes.insert(bytes.end(), begin, begin + size);
+}
+
+struct Reader {
+  const std::vector<uint8_t> &m_bytes;
+  size_t m_offset{0};
+
+  bool get(void *out, size_t size) {
+    if (size > m_bytes.size() - m_offset)
+      return false;
+    memcpy(out, m_bytes.data() + m_offset, size);
+    m_offset += size;
+    return true;
+  }
+  template <typename T> bool get(T &out) { return get(&out, sizeof(T)); }
+};
+
+bool valid_tile(uint8_t packed) {
+  return (packed >> 4) <= static_cast<uint8_t>(TileType::Road);
+}
+
+// minstd_rand has no getter for its state but prints it, and seeding with
+// the printed value gives the same engine back
+uint32_t rng_state(const Rng &rng) {
+  std::ostringstream out;
+  out << rng;
+  return std::stoul(out.str());
+}
+
+bool sync_file(FILE *file) {
+#ifdef _WIN32
+  return _commit(_fileno(file)) == 0;
+#else
+  return fsync(fileno(file)) == 0;
+#endif
+}
+
+// Makes a rename into the directory of path stick. Windows can't open a
+// directory to sync it, NTFS journals the rename on its own.
+bool sync_directory(const std::string &path) {
+#ifdef _WIN32
+  (void)path;
+  return true;
+#else
+  auto directory = std::filesystem::path{path}.parent_path();
+  if (directory.empty())
+    directory = ".";
+  const int fd = open(directory.c_str(), O_RDONLY);
+  if (fd < 0)
+    return false;
+  const bool ok = fsync(fd) == 0;
+  close(fd);
+  return ok;
+#endif
+}
+
+// Writes to a temporary name and only renames over path once the bytes are
+// on disk, so a crash leaves either the old or the new file
+bool write_durably(const std::string &path,
+                   const std::vector<uint8_t> &bytes) {
+  const auto temp_path = path + ".tmp";
+  FILE *file = fopen(temp_path.c_str(), "wb");
+  if (!file)
+    return false;
+
+  bool ok = fwrite(bytes.data(), bytes.size(), 1, file) == 1;
+  ok = ok && (fflush(file) == 0) && sync_file(file);
+  ok = (fclose(file) == 0) && ok;
+  if (!ok)
+    return false;
+
+  // Unlike std::rename this replaces an existing file on Windows too
+  std::error_code error;
+  std::filesystem::rename(temp_path, path, error);
+  return !error && sync_directory(path);
+}
+} // namespace
+
+void SaveState::capture(const Game &game,
+                        const std::vector<std::string> &log) {
+  for (uint8_t y{0}; y < Board::m_board_height; ++y) {
+    for (uint8_t x{0}; x < Board::m_board_width; ++x) {
+      m_tiles.at((y * Board::m_board_width) + x) =
+          game.board.get_tile(x, y).packed();
+    }
+  }
+  m_pile.clear();
+  for (const auto &tile : game.board.m_draw_pile)
+    m_pile.push_back(tile.packed());
+  m_next_tile = game.m_next_tile.packed();
+  m_eq_count = game.m_eq_count;
+  m_flags = (game.m_game_won ? flag_won : 0) |
+            (game.m_game_over ? flag_over : 0);
+  m_rng = game.m_rng;
+  m_log = log;
+}
+
+void SaveState::restore(Game &game, std::vector<std::string> &log) const {
+  for (uint8_t y{0}; y < Board::m_board_height; ++y) {
+    for (uint8_t x{0}; x < Board::m_board_width; ++x) {
+      game.board.get_tile(x, y).set_packed(
+          m_tiles.at((y * Board::m_board_width) + x));
+    }
+  }
+  game.board.m_draw_pile.clear();
+  for (const auto packed : m_pile) {
+    Tile tile;
+    tile.set_packed(packed);
+    game.board.m_draw_pile.push_back(tile);
+  }
+  game.board.rebuild_valid_moves();
+  game.board.recalculate_end_tiles();
+  game.board.recalculate_reachable_tiles();
+
+  game.m_next_tile.set_packed(m_next_tile);
+  game.m_eq_count = m_eq_count;
+  game.m_game_won = m_flags & flag_won;
+  game.m_game_over = m_flags & flag_over;
+  game.m_rng = m_rng;
+  log = m_log;
+}
+
+bool SaveState::is_finished() const { return m_flags & (flag_won | flag_over); }
+
+Autosave::Autosave(const char *path)
+    : m_path{path},
+      m_thread{[this](std::stop_token stop) { run(stop); }} {}
+
+Autosave::~Autosave() {
+  m_thread.request_stop();
+  m_wake.fetch_add(1, std::memory_order_release);
+  m_wake.notify_one();
+}
+
+void Autosave::submit() {
+  m_states.publish();
+  m_wake.fetch_add(1, std::memory_order_release);
+  m_wake.notify_one();
+}
+
+void Autosave::run(std::stop_token stop) {
+  trace_set_thread_name("autosave");
+
+  for (;;) {
+    // Same handshake as the game thread, a stop or submit after this load
+    // changes the value and the wait below returns right away
+    const auto wake = m_wake.load(std::memory_order_acquire);
+    const bool stopping = stop.stop_requested();
+
+    if (m_states.acquire() && !write(m_states.front()))
+      SDL_Log("Couldn't write autosave to %s", m_path.c_str());
+    if (stopping)
+      break;
+
+    m_wake.wait(wake, std::memory_order_acquire);
+  }
+}
+
+bool Autosave::write(const SaveState &state) const {
+  TRACE_ZONE("Autosave::write");
+
+  std::vector<uint8_t> bytes;
+  put(bytes, save_magic, sizeof(save_magic));
+  put(bytes, save_version);
+  put(bytes, rng_state(state.m_rng));
+  put(bytes, state.m_tiles.data(), state.m_tiles.size());
+  put(bytes, state.m_next_tile);
+  put(bytes, state.m_eq_count);
+  put(bytes, state.m_flags);
+  put(bytes, static_cast<uint8_t>(state.m_pile.size()));
+  put(bytes, state.m_pile.data(), state.m_pile.size());
+
+  const auto lines = std::min(state.m_log.size(), max_log_lines);
+  put(bytes, static_cast<uint16_t>(lines));
+  for (size_t i{state.m_log.size() - lines}; i < state.m_log.size(); ++i) {
+    const auto &line = state.m_log.at(i);
+    const auto length = std::min(line.size(), max_log_line);
+    put(bytes, static_cast<uint16_t>(length));
+    put(bytes, line.data(), length);
+  }
+
+  return write_durably(m_path, bytes);
+}
+
+bool Autosave::load(const char *path, SaveState &out) {
+  FILE *file = fopen(path, "rb");
+  if (!file)
+    return false;
+
+  std::vector<uint8_t> bytes;
+  uint8_t buffer[4096];
+  size_t read_count{0};
+  while ((read_count = fread(buffer, 1, sizeof(buffer), file)) > 0)
+    bytes.insert(bytes.end(), buffer, buffer + read_count);
+  fclose(file);
+
+  Reader reader{bytes};
+  char magic[4]{};
+  uint32_t version{0};
+  uint32_t state{0};
+  uint8_t pile_size{0};
+  bool ok = reader.get(magic, sizeof(magic)) &&
+            (memcmp(magic, save_magic, sizeof(magic)) == 0) &&
+            reader.get(version) && (version == save_version) &&
+            reader.get(state) && (state > 0) && (state < Rng::modulus) &&
+            reader.get(out.m_tiles.data(), out.m_tiles.size()) &&
+            reader.get(out.m_next_tile) && reader.get(out.m_eq_count) &&
+            reader.get(out.m_flags) && reader.get(pile_size) &&
+            (pile_size <= Board::m_board_size);
+  if (ok) {
+    out.m_pile.resize(pile_size);
+    ok = reader.get(out.m_pile.data(), pile_size);
+  }
+
+  uint16_t lines{0};
+  ok = ok && reader.get(lines) && (lines <= max_log_lines);
+  out.m_log.clear();
+  for (uint16_t i{0}; ok && (i < lines); ++i) {
+    uint16_t length{0};
+    ok = reader.get(length) && (length <= max_log_line);
+    if (ok) {
+      std::string line(length, '\0');
+      ok = reader.get(line.data(), length);
+      out.m_log.push_back(std::move(line));
+    }
+  }
+
+  for (const auto packed : out.m_tiles)
+    ok = ok && valid_tile(packed);
+  for (const auto packed : out.m_pile)
+    ok = ok && valid_tile(packed);
+  ok = ok && valid_tile(out.m_next_tile);
+  if (!ok)
+    return false;
+
+  out.m_rng.seed(state);
+  return true;
+}
@@ -1,16 +1,34 @@
 #include <algorithm>
 #include <cassert>
 #include <cstdio>
-#include <queue>
 #include <random>
 #include <string.h>
 #include <vector>
 
 #include "board.hpp"
+#include "geometry_batch.hpp"
+#include "random.hpp"
 #include "tile.hpp"
-
-extern int get_random();
-extern std::mt19937 eng;
+#include "trace.hpp"
+
+namespace {
+// Every visited tile queues at most its four neighbours, so the flood fills
+// can use a fixed ring instead of allocating a std::queue on each call
+struct TileQueue {
+  std::array<SDL_Point, (4 * Board::m_board_size) + 1> m_items;
+  size_t m_head{0};
+  size_t m_tail{0};
+
+  bool empty() const { return m_head == m_tail; }
+  const SDL_Point &front() const { return m_items.at(m_head); }
+  void pop() { m_head = (m_head + 1) % m_items.size(); }
+  void emplace(int x, int y) {
+    m_items.at(m_tail) = SDL_Point{x, y};
+    m_tail = (m_tail + 1) % m_items.size();
+  }
+  void emplace(const SDL_Point &p) { emplace(p.x, p.y); }
+};
+} // namespace
 
 void Board::init(int res_x, int res_y) {
   if (res_x > res_y) {
@@ -26,6 +44,25 @@ void Board::init(int res_x, int res_y) {
         (res_y * 0.5f) - ((m_board_height * m_tile_height) * 0.5f),
     };
   }
+  update_tile_rects();
+}
+
+void Board::init(const SDL_FRect &viewport) {
+  // Small gap so neighbouring boards don't touch
+  const float margin = std::min(viewport.w, viewport.h) * 0.04f;
+  const float tile_size =
+      std::min((viewport.w - 2 * margin) / m_board_width,
+               (viewport.h - 2 * margin) / m_board_height);
+  m_tile_height = m_tile_width = tile_size;
+  m_position = SDL_FPoint{
+      viewport.x + (viewport.w * 0.5f) -
+          ((m_board_width * m_tile_width) * 0.5f),
+      viewport.y + (viewport.h * 0.5f) -
+          ((m_board_height * m_tile_height) * 0.5f)};
+  update_tile_rects();
+}
+
+void Board::update_tile_rects() {
   m_board_rect =
       SDL_FRect{m_position.x, m_position.y, m_board_width * m_tile_width,
                 m_board_height * m_tile_height};
@@ -38,22 +75,28 @@ void Board::init(int res_x, int res_y) {
   }
 }
 
-void Board::new_game() {
+void Board::new_game(Rng &rng) {
   m_valid_moves.clear();
+  m_valid_moves.reserve(4 * m_board_size);
+  m_reached_end = false;
 
   for (int x{0}; x < m_board_width; ++x) {
     for (int y{0}; y < m_board_height; ++y) {
       auto &tile = get_tile(x, y);
       tile.m_type = TileType::None;
-      tile.m_selected = false;
+      tile.m_road_connections = 0;
     }
   }
 
   constexpr size_t equipment_count = 3;
-  for (size_t i{0}; i < equipment_count; ++i)
-    get_tile(get_random(), 1 + get_random()).m_type = TileType::Equipment;
+  for (size_t i{0}; i < equipment_count; ++i) {
+    // Rolled one at a time so a seed gives the same board on every compiler
+    const uint8_t x = get_random(rng);
+    const uint8_t y = 1 + get_random(rng);
+    get_tile(x, y).m_type = TileType::Equipment;
+  }
 
-  randomize_draw_pile();
+  randomize_draw_pile(rng);
 
   m_valid_moves.push_back({0, 7});
   m_valid_moves.push_back({5, 0});
@@ -62,7 +105,7 @@ void Board::new_game() {
   recalculate_end_tiles();
 }
 
-void Board::randomize_draw_pile() {
+void Board::randomize_draw_pile(Rng &rng) {
   m_draw_pile.clear();
 
   // Tiles:
@@ -102,7 +145,7 @@ void Board::randomize_draw_pile() {
   for (size_t i{0}; i < dragons_count; ++i)
     m_draw_pile.push_back(Tile{.m_type = TileType::Dragon});
 
-  std::ranges::shuffle(m_draw_pile, eng);
+  std::ranges::shuffle(m_draw_pile, rng);
 }
 
 Tile &Board::get_tile(uint8_t x, uint8_t y) {
@@ -111,31 +154,20 @@ Tile &Board::get_tile(uint8_t x, uint8_t y) {
   return m_tiles.at((y * m_board_width) + x);
 }
 
-void Board::set_selected(uint8_t x, uint8_t y) {
-  if (m_selected_tile)
-    m_selected_tile->m_selected = false;
-  m_selected_tile = &get_tile(x, y);
-  m_selected_tile->m_selected = true;
+const Tile &Board::get_tile(uint8_t x, uint8_t y) const {
+  assert(x < m_board_width);
+  assert(y < m_board_height);
+  return m_tiles.at((y * m_board_width) + x);
 }
 
-void Board::unselect() {
-  if (m_selected_tile) {
-    m_selected_tile->m_selected = false;
-    m_selected_tile = nullptr;
-  }
-}
+void Board::render(SDL_Renderer *r) const {
+  TRACE_ZONE("Board::render");
 
-void Board::render(SDL_Renderer *r) {
   for (auto &tile : m_tiles) {
     tile.render(r);
   }
 
   SDL_SetRenderDrawBlendMode(r, SDL_BLENDMODE_BLEND);
-  if (m_selected_tile) {
-    SDL_SetRenderDrawColor(r, 0xFF, 0xFF, 0xFF, 0x20);
-    SDL_RenderFillRect(r, &m_selected_tile->m_rect);
-  }
-
   SDL_SetRenderDrawColor(r, 0x0, 0xFF, 0x0, 0x20);
   for (auto &point : m_valid_moves) {
     SDL_RenderFillRect(r, &get_tile(point.x, point.y).m_rect);
@@ -157,7 +189,29 @@ void Board::render(SDL_Renderer *r) {
   SDL_SetRenderDrawColor(r, 0xFF, 0x0, 0x0, 0xFF);
 }
 
+void Board::render_selection(SDL_Renderer *r, uint8_t x, uint8_t y) const {
+  SDL_SetRenderDrawBlendMode(r, SDL_BLENDMODE_BLEND);
+  SDL_SetRenderDrawColor(r, 0xFF, 0xFF, 0xFF, 0x20);
+  SDL_RenderFillRect(r, &get_tile(x, y).m_rect);
+  SDL_SetRenderDrawBlendMode(r, SDL_BLENDMODE_NONE);
+}
+
+void Board::render(GeometryBatch &batch) const {
+  TRACE_ZONE("Board::render batched");
+
+  for (auto &tile : m_tiles) {
+    tile.render(batch);
+  }
+
+  for (auto &point : m_valid_moves) {
+    batch.add_rect(get_tile(point.x, point.y).m_rect,
+                   SDL_Color{0x0, 0xFF, 0x0, 0x20});
+  }
+}
+
 void Board::add_valid_moves_from_tile(const int x, const int y) {
+  TRACE_ZONE("Board::add_valid_moves_from_tile");
+
   const auto &tile = get_tile(x, y);
   const std::array<RoadConnections, 4> connections = {
       RoadConnections::Up, RoadConnections::Down, RoadConnections::Left,
@@ -218,6 +272,8 @@ void Board::add_valid_moves_from_tile(const int x, const int y) {
 }
 
 void Board::update_valid_moves() {
+  TRACE_ZONE("Board::update_valid_moves");
+
   std::erase_if(m_valid_moves, [this](const SDL_Point &p) -> bool {
     bool valid_move{false};
 
@@ -260,11 +316,34 @@ void Board::update_valid_moves() {
   });
 }
 
+// Valid moves depend only on the tiles, so they can be recreated after the
+// board was restored from a snapshot
+void Board::rebuild_valid_moves() {
+  m_valid_moves.clear();
+
+  for (const auto &corner : {m_start_tile, m_finish_tile}) {
+    const auto type = get_tile(corner.x, corner.y).m_type;
+    if ((type == TileType::None) || (type == TileType::Equipment))
+      m_valid_moves.push_back(corner);
+  }
+
+  for (int x{0}; x < m_board_width; ++x) {
+    for (int y{0}; y < m_board_height; ++y) {
+      if (get_tile(x, y).m_type == TileType::Road)
+        add_valid_moves_from_tile(x, y);
+    }
+  }
+
+  update_valid_moves();
+}
+
 void Board::recalculate_reachable_tiles() {
+  TRACE_ZONE("Board::recalculate_reachable_tiles");
+
   memset(m_reachable_tiles.data(), 0, m_board_size * sizeof(SDL_Point));
   m_reachable_tiles_count = 0;
 
-  std::queue<SDL_Point> tiles_to_check;
+  TileQueue tiles_to_check;
   std::array<bool, m_board_size> visited{false};
   tiles_to_check.emplace(m_start_tile);
 
@@ -311,10 +390,13 @@ void Board::recalculate_reachable_tiles() {
 }
 
 void Board::recalculate_end_tiles() {
+  TRACE_ZONE("Board::recalculate_end_tiles");
+
   memset(m_end_tiles.data(), 0, m_board_size * sizeof(SDL_Point));
   m_end_tiles_count = 0;
+  m_reached_end = false;
 
-  std::queue<SDL_Point> tiles_to_check;
+  TileQueue tiles_to_check;
   std::array<bool, m_board_size> visited{false};
   tiles_to_check.emplace(m_finish_tile);
 
@@ -352,6 +434,8 @@ void Board::recalculate_end_tiles() {
 }
 
 bool Board::can_reach_end() {
+  TRACE_ZONE("Board::can_reach_end");
+
   for (int i{m_reachable_tiles_count - 1}; i >= 0; --i) {
     auto tile = m_reachable_tiles.at(i);
     for (int j{0}; j < m_end_tiles_count; ++j) {
@@ -0,0 +1,188 @@
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <random>
+#include <vector>
+
+#include "board.hpp"
+#include "dragons_env.h"
+#include "game.hpp"
+#include "tile.hpp"
+#include "worker_pool.hpp"
+
+static_assert(DA_BOARD_WIDTH == Board::m_board_width);
+static_assert(DA_BOARD_HEIGHT == Board::m_board_height);
+
+struct da_env_batch {
+  std::vector<Game> games;
+  WorkerPool pool;
+
+  da_env_batch(uint32_t count, unsigned thread_count)
+      : games(count), pool(thread_count) {}
+};
+
+namespace {
+// Small batches aren't worth waking the other threads for
+constexpr size_t chunk_size = 64;
+
+void start_game(Game &game) {
+  // Initial dragons can in theory end a game before the first move
+  do {
+    game.new_game();
+  } while (game.is_finished());
+}
+
+void write_observation(const Game &game, uint8_t *obs, uint8_t *action_mask) {
+  memset(obs, 0, DA_OBS_SIZE);
+  const auto &board = game.board;
+
+  for (uint8_t y{0}; y < Board::m_board_height; ++y) {
+    for (uint8_t x{0}; x < Board::m_board_width; ++x) {
+      const auto &tile = board.get_tile(x, y);
+      const auto cell = (y * DA_BOARD_WIDTH) + x;
+
+      switch (tile.m_type) {
+      case TileType::None:
+        obs[(DA_PLANE_EMPTY * DA_CELL_COUNT) + cell] = 1;
+        break;
+      case TileType::Equipment:
+        obs[(DA_PLANE_EQUIPMENT * DA_CELL_COUNT) + cell] = 1;
+        break;
+      case TileType::Dragon:
+        obs[(DA_PLANE_DRAGON * DA_CELL_COUNT) + cell] = 1;
+        break;
+      case TileType::Road:
+        obs[(DA_PLANE_ROAD * DA_CELL_COUNT) + cell] = 1;
+        break;
+      }
+
+      for (int con{0}; con < 4; ++con) {
+        if (tile.m_road_connections & (1 << con))
+          obs[((DA_PLANE_ROAD_UP + con) * DA_CELL_COUNT) + cell] = 1;
+      }
+    }
+  }
+
+  for (auto &p : board.m_valid_moves)
+    obs[(DA_PLANE_VALID_MOVE * DA_CELL_COUNT) + (p.y * DA_BOARD_WIDTH) + p.x] =
+        1;
+
+  obs[DA_OBS_NEXT_TILE_TYPE + static_cast<int>(game.m_next_tile.m_type)] = 1;
+  for (int con{0}; con < 4; ++con) {
+    if (game.m_next_tile.m_road_connections & (1 << con))
+      obs[DA_OBS_NEXT_TILE_ROAD + con] = 1;
+  }
+  obs[DA_OBS_EQUIPMENT_COUNT] = game.m_eq_count;
+
+  uint8_t roads{0};
+  uint8_t dragons{0};
+  for (auto &tile : board.m_draw_pile) {
+    if (tile.m_type == TileType::Road)
+      roads++;
+    else if (tile.m_type == TileType::Dragon)
+      dragons++;
+  }
+  obs[DA_OBS_PILE_ROADS] = roads;
+  obs[DA_OBS_PILE_DRAGONS] = dragons;
+
+  if (!action_mask)
+    return;
+
+  memset(action_mask, 0, DA_ACTION_COUNT);
+  if (game.is_finished() || (game.m_next_tile.m_type != TileType::Road))
+    return;
+
+  std::array<Tile, 4> rotations{};
+  Tile rotated = game.m_next_tile;
+  for (auto &r : rotations) {
+    r = rotated;
+    rotated.rotate();
+  }
+
+  for (auto &p : board.m_valid_moves) {
+    const auto cell = (p.y * DA_BOARD_WIDTH) + p.x;
+    for (size_t r{0}; r < rotations.size(); ++r) {
+      if (game.is_placement_valid(rotations.at(r), p.x, p.y))
+        action_mask[(cell * 4) + r] = 1;
+    }
+  }
+}
+} // namespace
+
+extern "C" {
+
+da_env_batch *da_env_batch_create(uint32_t count, uint64_t seed,
+                                  uint32_t thread_count) {
+  // Nothing may throw past the C boundary, allocating the games and
+  // starting the pool threads both can
+  try {
+    auto batch = std::make_unique<da_env_batch>(count, thread_count);
+    for (uint32_t i{0}; i < count; ++i) {
+      std::seed_seq seq{static_cast<uint32_t>(seed),
+                        static_cast<uint32_t>(seed >> 32), i};
+      batch->games.at(i).m_rng.seed(seq);
+    }
+    return batch.release();
+  } catch (...) {
+    return nullptr;
+  }
+}
+
+void da_env_batch_destroy(da_env_batch *batch) { delete batch; }
+
+uint32_t da_env_batch_size(const da_env_batch *batch) {
+  return batch->games.size();
+}
+
+void da_env_batch_reset(da_env_batch *batch, uint8_t *obs,
+                        uint8_t *action_mask) {
+  auto job = [batch, obs, action_mask](size_t begin, size_t end) {
+    for (size_t i{begin}; i < end; ++i) {
+      auto &game = batch->games[i];
+      start_game(game);
+      write_observation(game, obs + (i * DA_OBS_SIZE),
+                        action_mask ? action_mask + (i * DA_ACTION_COUNT)
+                                    : nullptr);
+    }
+  };
+  batch->pool.parallel_for(batch->games.size(), chunk_size, job);
+}
+
+void da_env_batch_step(da_env_batch *batch, const uint32_t *actions,
+                       uint8_t *obs, uint8_t *action_mask, float *rewards,
+                       uint8_t *dones) {
+  auto job = [=](size_t begin, size_t end) {
+    for (size_t i{begin}; i < end; ++i) {
+      auto &game = batch->games[i];
+      const auto action = actions[i];
+      const auto cell = action / 4;
+      float reward{0.0f};
+      bool done{false};
+
+      if ((action >= DA_ACTION_COUNT) ||
+          !game.play(Placement{static_cast<uint8_t>(cell % DA_BOARD_WIDTH),
+                               static_cast<uint8_t>(cell / DA_BOARD_WIDTH),
+                               static_cast<uint8_t>(action % 4)})) {
+        reward = DA_REWARD_ILLEGAL;
+      } else if (game.m_game_won) {
+        reward = DA_REWARD_WIN;
+        done = true;
+      } else if (game.m_game_over) {
+        reward = DA_REWARD_LOSS;
+        done = true;
+      }
+
+      if (done)
+        start_game(game);
+
+      rewards[i] = reward;
+      dones[i] = done;
+      write_observation(game, obs + (i * DA_OBS_SIZE),
+                        action_mask ? action_mask + (i * DA_ACTION_COUNT)
+                                    : nullptr);
+    }
+  };
+  batch->pool.parallel_for(batch->games.size(), chunk_size, job);
+}
+}
@@ -0,0 +1,278 @@
+#include <algorithm>
+#include <array>
+#include <format>
+
+#include "analysis.hpp"
+#include "board.hpp"
+#include "game.hpp"
+#include "random.hpp"
+#include "tile.hpp"
+#include "trace.hpp"
+
+void Game::new_game() {
+  board.new_game(m_rng);
+  m_next_tile.m_type = TileType::None;
+  draw_next_tile();
+  m_eq_count = 0;
+  m_game_over = false;
+  m_game_won = false;
+
+  // First tile of the pile can already be a dragon
+  if (m_next_tile.m_type == TileType::Dragon) {
+    resolve_dragons();
+    finish_turn();
+  }
+}
+
+bool Game::draw_next_tile() {
+  const SDL_FRect drawn_tile_rect = m_next_tile.m_rect;
+
+  if (board.m_draw_pile.empty()) {
+    m_next_tile.m_type = TileType::None;
+    m_next_tile.m_road_connections = 0;
+    return false;
+  }
+
+  m_next_tile = board.m_draw_pile.back();
+  m_next_tile.m_rect = drawn_tile_rect;
+  board.m_draw_pile.pop_back();
+  return true;
+}
+
+bool Game::is_move_valid(uint8_t x, uint8_t y) const {
+  return is_placement_valid(m_next_tile, x, y);
+}
+
+bool Game::is_placement_valid(const Tile &tile_to_place, uint8_t x,
+                              uint8_t y) const {
+  auto result = std::ranges::find_if(
+      board.m_valid_moves,
+      [x, y](const SDL_Point &p) -> bool { return p.x == x && p.y == y; });
+  if (result == std::end(board.m_valid_moves))
+    return false;
+
+  if ((x == 0) && (y == board.m_board_height - 1))
+    if (tile_to_place.has_road_connection(RoadConnections::Left))
+      return true;
+
+  if ((x == board.m_board_width - 1) && (y == 0))
+    if (tile_to_place.has_road_connection(RoadConnections::Up))
+      return true;
+
+  const std::array<RoadConnections, 4> connections = {
+      RoadConnections::Up, RoadConnections::Down, RoadConnections::Left,
+      RoadConnections::Right};
+  bool valid{false};
+  for (auto &con : connections) {
+    switch (con) {
+    // bug on edges when testing for connections
+    case RoadConnections::Up:
+      if ((y > 0) && tile_to_place.has_road_connection(con))
+        valid = valid || board.get_tile(x, y - 1).has_road_connection(
+                             RoadConnections::Down);
+      break;
+    case RoadConnections::Right:
+      if ((x < board.m_board_width - 1) &&
+          tile_to_place.has_road_connection(con))
+        valid = valid || board.get_tile(x + 1, y).has_road_connection(
+                             RoadConnections::Left);
+      break;
+    case RoadConnections::Down:
+      if ((y < board.m_board_height - 1) &&
+          tile_to_place.has_road_connection(con))
+        valid = valid || board.get_tile(x, y + 1).has_road_connection(
+                             RoadConnections::Up);
+      break;
+    case RoadConnections::Left:
+      if ((x > 0) && tile_to_place.has_road_connection(con))
+        valid = valid || board.get_tile(x - 1, y).has_road_connection(
+                             RoadConnections::Right);
+      break;
+    }
+  }
+
+  return valid;
+}
+
+size_t Game::legal_placements(Placements &out) const {
+  size_t count{0};
+  if (is_finished() || (m_next_tile.m_type != TileType::Road))
+    return count;
+
+  // Symmetric tiles give the same road for several rotations, only the first
+  // one of them is reported
+  std::array<Tile, 4> rotations{};
+  std::array<bool, 4> unique{};
+  Tile rotated = m_next_tile;
+  for (size_t r{0}; r < rotations.size(); ++r) {
+    rotations.at(r) = rotated;
+    unique.at(r) = std::none_of(
+        rotations.begin(), rotations.begin() + r, [&rotated](const Tile &t) {
+          return t.m_road_connections == rotated.m_road_connections;
+        });
+    rotated.rotate();
+  }
+
+  std::array<bool, Board::m_board_size> seen{false};
+  for (auto &p : board.m_valid_moves) {
+    const auto index = (p.y * board.m_board_width) + p.x;
+    if (seen.at(index))
+      continue;
+    seen.at(index) = true;
+
+    for (size_t r{0}; r < rotations.size(); ++r) {
+      if (unique.at(r) && is_placement_valid(rotations.at(r), p.x, p.y))
+        out.at(count++) =
+            Placement{static_cast<uint8_t>(p.x), static_cast<uint8_t>(p.y),
+                      static_cast<uint8_t>(r)};
+    }
+  }
+
+  return count;
+}
+
+bool Game::place_next_tile(uint8_t x, uint8_t y) {
+  if (is_finished() || (m_next_tile.m_type != TileType::Road))
+    return false;
+
+  if (!is_move_valid(x, y))
+    return false;
+
+  auto &tile = board.get_tile(x, y);
+  if ((tile.m_type != TileType::None) && (tile.m_type != TileType::Equipment))
+    return false;
+
+  if (tile.m_type == TileType::Equipment) {
+    m_eq_count++;
+    if (m_log)
+      m_log(m_log_context,
+            std::format("Knights equipment gathered! You've got {} pieces.",
+                        m_eq_count)
+                .c_str());
+  }
+
+  std::erase_if(board.m_valid_moves, [x, y](const SDL_Point &p) -> bool {
+    return p.x == x && p.y == y;
+  });
+
+  const SDL_FRect tile_rect = tile.m_rect;
+  tile = m_next_tile;
+  tile.m_rect = tile_rect;
+  board.add_valid_moves_from_tile(x, y);
+  draw_next_tile();
+
+  board.recalculate_end_tiles();
+  if (board.m_reached_end)
+    m_game_won = true;
+
+  return true;
+}
+
+bool Game::land_dragon(uint8_t x, uint8_t y) {
+  auto &tile = board.get_tile(x, y);
+  if (tile.m_type == TileType::Dragon)
+    return false;
+
+  if (m_log)
+    m_log(m_log_context,
+          std::format("Dragon lands on tile {}, {}", x, y).c_str());
+
+  if ((tile.m_type == TileType::Road) && (m_eq_count > 0)) {
+    m_eq_count--;
+    if (m_log)
+      m_log(m_log_context,
+            std::format("Dragon was defeated using Knight's "
+                        "Equipment. Pieces left: {}",
+                        m_eq_count)
+                .c_str());
+  } else if (tile.m_type == TileType::Equipment) {
+    tile.m_type = TileType::None;
+    if (m_log)
+      m_log(m_log_context,
+            "Dragon was defeated using Knight's Equipment from the board");
+  } else {
+    const SDL_FRect tile_rect = tile.m_rect;
+    tile = m_next_tile;
+    tile.m_rect = tile_rect;
+  }
+
+  // Defeated or not, the dragon is used up
+  draw_next_tile();
+  return true;
+}
+
+void Game::resolve_dragons() {
+  TRACE_ZONE("Game::resolve_dragons");
+
+  while (m_next_tile.m_type == TileType::Dragon) {
+    const uint8_t x = get_random(m_rng);
+    const uint8_t y = 1 + get_random(m_rng);
+    land_dragon(x, y);
+  }
+}
+
+void Game::finish_turn() {
+  TRACE_ZONE("Game::finish_turn");
+
+  board.update_valid_moves();
+  if (board.m_valid_moves.empty()) {
+    m_game_over = true;
+    return;
+  }
+
+  board.recalculate_end_tiles();
+  if (board.m_reached_end) {
+    m_game_won = true;
+    return;
+  }
+
+  board.recalculate_reachable_tiles();
+
+  if (!board.can_reach_end())
+    m_game_over = true;
+
+  // Pile ran out before the road was finished
+  if (m_next_tile.m_type == TileType::None)
+    m_game_over = true;
+
+  if (!m_game_over && is_doomed(*this)) {
+    m_game_over = true;
+    if (m_log)
+      m_log(m_log_context, "Not enough road tiles left to reach the end");
+  }
+}
+
+bool Game::take_turn(uint8_t x, uint8_t y) {
+  if (!place_next_tile(x, y))
+    return false;
+
+  if (!m_game_won) {
+    resolve_dragons();
+    finish_turn();
+  }
+  return true;
+}
+
+bool Game::play(const Placement &placement) {
+  TRACE_ZONE("Game::play");
+
+  if (is_finished() || (m_next_tile.m_type != TileType::Road))
+    return false;
+
+  Tile rotated = m_next_tile;
+  for (uint8_t i{0}; i < placement.rotation % 4; ++i)
+    rotated.rotate();
+
+  if (!is_placement_valid(rotated, placement.x, placement.y))
+    return false;
+
+  m_next_tile = rotated;
+  return take_turn(placement.x, placement.y);
+}
+
+void Game::after_placement(const Placement &placement, Game &out) const {
+  out = *this;
+  for (uint8_t i{0}; i < placement.rotation % 4; ++i)
+    out.m_next_tile.rotate();
+  out.place_next_tile(placement.x, placement.y);
+}
@@ -0,0 +1,134 @@
+#include <SDL3/SDL_log.h>
+
+#include <atomic>
+#include <stop_token>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "autosave.hpp"
+#include "game.hpp"
+#include "game_thread.hpp"
+#include "trace.hpp"
+
+void GameSnapshot::capture(const Game &game) {
+  board = game.board;
+  m_next_tile = game.m_next_tile;
+  m_game_over = game.m_game_over;
+  m_game_won = game.m_game_won;
+}
+
+GameThread::GameThread(const Game &setup) : m_game{setup} {
+  m_game.m_log = log_message;
+  m_game.m_log_context = this;
+
+  // First game is set up here so there's a snapshot before the first frame
+  SaveState saved;
+  if (Autosave::load(m_save_path, saved) && !saved.is_finished()) {
+    saved.restore(m_game, m_log);
+    trim_log();
+    // Replay of a resumed game starts where it was picked up
+    m_replay.clear();
+    m_replay.record(m_game);
+    SDL_Log("Resumed game from %s", m_save_path);
+  } else {
+    new_game();
+  }
+  publish();
+
+  m_thread = std::jthread{[this](std::stop_token stop) { run(stop); }};
+}
+
+GameThread::~GameThread() {
+  m_thread.request_stop();
+  m_wake.fetch_add(1, std::memory_order_release);
+  m_wake.notify_one();
+}
+
+bool GameThread::push(const Command &command) {
+  if (!m_queue.push(command))
+    return false;
+
+  m_wake.fetch_add(1, std::memory_order_release);
+  m_wake.notify_one();
+  return true;
+}
+
+void GameThread::run(std::stop_token stop) {
+  trace_set_thread_name("logic");
+
+  for (;;) {
+    // Read before the stop check, a stop requested after it changes the
+    // value and the wait below returns right away
+    const auto wake = m_wake.load(std::memory_order_acquire);
+    if (stop.stop_requested())
+      break;
+
+    if (m_queue.drain([this](const Command &command) { apply(command); }) > 0)
+      publish();
+
+    m_wake.wait(wake, std::memory_order_acquire);
+  }
+
+  if ((m_replay.turn_count() > 1) && !m_replay.save(m_replay_path))
+    SDL_Log("Couldn't save replay to %s", m_replay_path);
+}
+
+void GameThread::apply(const Command &command) {
+  TRACE_ZONE("GameThread::apply");
+
+  m_input_ns = command.m_timestamp_ns;
+  if (command.m_type == CommandType::NewGame) {
+    new_game();
+    return;
+  }
+  if (m_game.is_finished())
+    return;
+
+  if (command.m_type == CommandType::Rotate) {
+    m_game.m_next_tile.rotate();
+    return;
+  }
+
+  if (!m_game.take_turn(command.m_x, command.m_y))
+    return;
+  m_replay.record(m_game);
+  save();
+  if (m_game.is_finished() && !m_replay.save(m_replay_path))
+    SDL_Log("Couldn't save replay to %s", m_replay_path);
+}
+
+void GameThread::log_message(void *context, const char *message) {
+  auto *self = static_cast<GameThread *>(context);
+  self->m_log.emplace_back(message);
+  self->trim_log();
+}
+
+void GameThread::trim_log() {
+  if (m_log.size() > m_max_log_lines)
+    m_log.erase(m_log.begin(), m_log.end() - m_max_log_lines);
+}
+
+void GameThread::new_game() {
+  m_log.clear();
+  m_game.new_game();
+  m_replay.clear();
+  m_replay.record(m_game);
+  save();
+}
+
+void GameThread::publish() {
+  TRACE_ZONE("GameThread::publish");
+
+  auto &snapshot = m_snapshots.back();
+  snapshot.capture(m_game);
+  snapshot.m_log = m_log;
+  snapshot.m_input_ns = m_input_ns;
+  m_snapshots.publish();
+}
+
+void GameThread::save() {
+  // Only whole turns are saved, a rotation alone isn't worth a disk write
+  m_autosave.next().capture(m_game, m_log);
+  m_autosave.submit();
+}
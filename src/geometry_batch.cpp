@@ -0,0 +1,49 @@
+#include <SDL3/SDL_blendmode.h>
+#include <SDL3/SDL_pixels.h>
+#include <SDL3/SDL_rect.h>
+#include <SDL3/SDL_render.h>
+
+#include "geometry_batch.hpp"
+
+void GeometryBatch::clear() {
+  m_vertices.clear();
+  m_indices.clear();
+}
+
+void GeometryBatch::add_rect(const SDL_FRect &rect, const SDL_Color &color) {
+  const SDL_FColor c{color.r / 255.0f, color.g / 255.0f, color.b / 255.0f,
+                     color.a / 255.0f};
+  const int first = m_vertices.size();
+
+  m_vertices.push_back(SDL_Vertex{{rect.x, rect.y}, c, {}});
+  m_vertices.push_back(SDL_Vertex{{rect.x + rect.w, rect.y}, c, {}});
+  m_vertices.push_back(SDL_Vertex{{rect.x + rect.w, rect.y + rect.h}, c, {}});
+  m_vertices.push_back(SDL_Vertex{{rect.x, rect.y + rect.h}, c, {}});
+
+  m_indices.push_back(first);
+  m_indices.push_back(first + 1);
+  m_indices.push_back(first + 2);
+  m_indices.push_back(first);
+  m_indices.push_back(first + 2);
+  m_indices.push_back(first + 3);
+}
+
+void GeometryBatch::add_outline(const SDL_FRect &rect, float thickness,
+                                const SDL_Color &color) {
+  add_rect(SDL_FRect{rect.x, rect.y, rect.w, thickness}, color);
+  add_rect(SDL_FRect{rect.x, rect.y + rect.h - thickness, rect.w, thickness},
+           color);
+  add_rect(SDL_FRect{rect.x, rect.y, thickness, rect.h}, color);
+  add_rect(SDL_FRect{rect.x + rect.w - thickness, rect.y, thickness, rect.h},
+           color);
+}
+
+void GeometryBatch::draw(SDL_Renderer *r) const {
+  if (m_indices.empty())
+    return;
+
+  SDL_SetRenderDrawBlendMode(r, SDL_BLENDMODE_BLEND);
+  SDL_RenderGeometry(r, nullptr, m_vertices.data(), m_vertices.size(),
+                     m_indices.data(), m_indices.size());
+  SDL_SetRenderDrawBlendMode(r, SDL_BLENDMODE_NONE);
+}
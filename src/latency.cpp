@@ -0,0 +1,63 @@
+#include <SDL3/SDL_log.h>
+
+#include <algorithm>
+#include <vector>
+
+#include "latency.hpp"
+
+void LatencyTracker::set_refresh_rate(float hz) {
+  if (hz > 0.0f)
+    m_frame_budget_ns = static_cast<uint64_t>(1'000'000'000.0f / hz);
+}
+
+void LatencyTracker::input(uint64_t timestamp_ns) {
+  // Events that can't be tracked are dropped rather than delaying the frame
+  if (m_pending_count < m_max_pending)
+    m_pending.at(m_pending_count++) = timestamp_ns;
+}
+
+void LatencyTracker::presented(uint64_t now_ns) {
+  for (size_t i{0}; i < m_pending_count; ++i) {
+    const auto ts = m_pending.at(i);
+    const uint64_t latency = now_ns > ts ? now_ns - ts : 0;
+
+    m_samples.at(m_next_sample) = latency;
+    m_next_sample = (m_next_sample + 1) % m_max_samples;
+    m_sample_count = std::min(m_sample_count + 1, m_max_samples);
+
+    m_total_count++;
+    if (latency > m_frame_budget_ns)
+      m_over_budget_count++;
+  }
+  m_pending_count = 0;
+}
+
+uint64_t LatencyTracker::percentile(float p) const {
+  if (m_sample_count == 0)
+    return 0;
+
+  std::vector<uint64_t> sorted(m_samples.begin(),
+                               m_samples.begin() + m_sample_count);
+  const auto rank = static_cast<size_t>(p * (m_sample_count - 1) + 0.5f);
+  std::ranges::nth_element(sorted, sorted.begin() + rank);
+  return sorted.at(rank);
+}
+
+void LatencyTracker::report() const {
+  constexpr double ns_per_ms = 1'000'000.0;
+
+  if (m_sample_count == 0) {
+    SDL_Log("Input latency: no samples yet");
+    return;
+  }
+
+  SDL_Log("Input latency over last %zu events: p50 %.2f ms, p90 %.2f ms, "
+          "p99 %.2f ms, max %.2f ms",
+          m_sample_count, percentile(0.5f) / ns_per_ms,
+          percentile(0.9f) / ns_per_ms, percentile(0.99f) / ns_per_ms,
+          percentile(1.0f) / ns_per_ms);
+  SDL_Log("Input latency over one frame (%.2f ms): %llu of %llu events",
+          m_frame_budget_ns / ns_per_ms,
+          static_cast<unsigned long long>(m_over_budget_count),
+          static_cast<unsigned long long>(m_total_count));
+}
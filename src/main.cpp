@@ -8,250 +8,147 @@
 #include <SDL3_ttf/SDL_ttf.h>
 
 #include <algorithm>
+#include <climits>
 #include <cstdint>
 #include <cstdio>
+#include <cstdlib>
 #include <filesystem>
 #include <format>
+#include <optional>
 #include <random>
+#include <string>
+#include <string_view>
+#include <thread>
 #include <vector>
 
 #include "SDL3/SDL_error.h"
 #include "SDL3/SDL_keycode.h"
 #include "board.hpp"
+#include "game.hpp"
+#include "game_thread.hpp"
+#include "latency.hpp"
+#include "replay_viewer.hpp"
 #include "tile.hpp"
+#include "trace.hpp"
+#include "wall.hpp"
 
 std::random_device rd;
-std::mt19937 eng{std::mt19937(rd())};
-std::uniform_int_distribution<> distr{std::uniform_int_distribution<>(0, 5)};
-std::vector<std::string> game_log{};
-
-void add_log_message(const char *message) { game_log.emplace_back(message); }
-
-int get_random() { return distr(eng); }
 
 struct State {
   SDL_Renderer *renderer;
   SDL_Window *window;
   TTF_Font *font;
-  Board board{};
   bool m_running{true};
-  Tile m_next_tile;
-  uint8_t m_eq_count{0};
-  bool m_game_over{false};
-  bool m_game_won{false};
+  LatencyTracker latency{};
+  // Only drawn, so hovering never has to go through the logic thread
+  std::optional<SDL_Point> m_hovered;
 };
 
-void new_game(State &state) {
-  state.board.new_game();
-  state.m_next_tile = state.board.m_draw_pile.back();
-  state.board.m_draw_pile.pop_back();
-  const SDL_FRect drawn_tile_rect{10.0f, 80.0f, state.board.m_tile_width,
-                                  state.board.m_tile_height};
-  state.m_next_tile.m_rect = drawn_tile_rect;
-  state.m_game_over = false;
-  state.m_game_won = false;
-  game_log.clear();
+SDL_FRect drawn_tile_rect(const Board &board) {
+  return SDL_FRect{10.0f, 80.0f, board.m_tile_width, board.m_tile_height};
 }
 
-bool is_move_valid(State &st, uint8_t x, uint8_t y) {
-  auto result = std::ranges::find_if(
-      st.board.m_valid_moves,
-      [x, y](const SDL_Point &p) -> bool { return p.x == x && p.y == y; });
-  if (result == std::end(st.board.m_valid_moves))
-    return false;
-
-  auto &tile_to_place = st.m_next_tile;
-
-  if ((x == 0) && (y == st.board.m_board_height - 1))
-    if (tile_to_place.has_road_connection(RoadConnections::Left))
-      return true;
-
-  if ((x == st.board.m_board_width - 1) && (y == 0))
-    if (tile_to_place.has_road_connection(RoadConnections::Up))
-      return true;
-
-  const std::array<RoadConnections, 4> connections = {
-      RoadConnections::Up, RoadConnections::Down, RoadConnections::Left,
-      RoadConnections::Right};
-  bool valid{false};
-  for (auto &con : connections) {
-    switch (con) {
-    // bug on edges when testing for connections
-    case RoadConnections::Up:
-      if ((y > 0) && tile_to_place.has_road_connection(con))
-        valid = valid || st.board.get_tile(x, y - 1).has_road_connection(
-                             RoadConnections::Down);
-      break;
-    case RoadConnections::Right:
-      if ((x < st.board.m_board_width - 1) &&
-          tile_to_place.has_road_connection(con))
-        valid = valid || st.board.get_tile(x + 1, y).has_road_connection(
-                             RoadConnections::Left);
-      break;
-    case RoadConnections::Down:
-      if ((y < st.board.m_board_height - 1) &&
-          tile_to_place.has_road_connection(con))
-        valid = valid || st.board.get_tile(x, y + 1).has_road_connection(
-                             RoadConnections::Up);
-      break;
-    case RoadConnections::Left:
-      if ((x > 0) && tile_to_place.has_road_connection(con))
-        valid = valid || st.board.get_tile(x - 1, y).has_road_connection(
-                             RoadConnections::Right);
-      break;
-    }
-  }
+std::optional<SDL_Point> cell_at(const Board &board, const SDL_FPoint &p) {
+  if (!SDL_PointInRectFloat(&p, &board.m_board_rect))
+    return std::nullopt;
+
+  // The rect test includes the far edges, which would be one cell past
+  const int x = (p.x - board.m_position.x) / board.m_tile_width;
+  const int y = (p.y - board.m_position.y) / board.m_tile_height;
+  return SDL_Point{std::min(x, Board::m_board_width - 1),
+                   std::min(y, Board::m_board_height - 1)};
+}
 
-  return valid;
+// A full queue means the logic thread is far behind. Player input still has
+// to get there, so this waits for room rather than dropping it.
+void send(GameThread &logic, const Command &command) {
+  if (logic.push(command))
+    return;
+
+  SDL_Log("Command queue full, waiting for the logic thread");
+  while (!logic.push(command))
+    std::this_thread::yield();
 }
 
-void update(State &st) {
-  bool board_changed{false};
+void update(State &st, GameThread &logic) {
+  TRACE_ZONE("update");
+
+  const auto &snapshot = logic.snapshot();
+  bool pointer_moved{false};
+  SDL_FPoint pointer{};
   SDL_Event event;
 
   while (SDL_PollEvent(&event)) {
+    const uint64_t timestamp = event.common.timestamp;
+
     if (event.type == SDL_EVENT_QUIT) {
       st.m_running = false;
     } else if (event.type == SDL_EVENT_KEY_DOWN) {
-      if (event.key.key == SDLK_ESCAPE)
+      if (event.key.key == SDLK_ESCAPE) {
         st.m_running = false;
-      else if (event.key.key == SDLK_N)
-        new_game(st);
-    } else if (event.type == SDL_EVENT_MOUSE_MOTION) {
-      const auto p = SDL_FPoint{event.motion.x, event.motion.y};
-      if (SDL_PointInRectFloat(&p, &st.board.m_board_rect)) {
-        const auto tile_x =
-            (p.x - st.board.m_position.x) / st.board.m_tile_width;
-        const auto tile_y =
-            (p.y - st.board.m_position.y) / st.board.m_tile_height;
-        st.board.set_selected(tile_x, tile_y);
-      } else {
-        st.board.unselect();
+      } else if (event.key.key == SDLK_N) {
+        // Latency of commands is counted once a snapshot shows them
+        send(logic, Command{CommandType::NewGame, 0, 0, timestamp});
+      } else if (event.key.key == SDLK_L) {
+        st.latency.input(timestamp);
+        st.latency.report();
+      } else if (event.key.key == SDLK_F12) {
+        st.latency.input(timestamp);
+        if (trace_write_json("dragons_trace.json"))
+          SDL_Log("Trace written to dragons_trace.json");
+        else
+          SDL_Log("Couldn't write trace, is DRAGONS_TRACE enabled?");
       }
-    } else if (st.m_game_over || st.m_game_won) {
-      return;
+    } else if (event.type == SDL_EVENT_MOUSE_MOTION) {
+      // Only the latest position matters, selection is applied once per frame
+      st.latency.input(timestamp);
+      pointer = SDL_FPoint{event.motion.x, event.motion.y};
+      pointer_moved = true;
     } else if (event.type == SDL_EVENT_MOUSE_BUTTON_DOWN) {
       if (event.button.button == SDL_BUTTON_LEFT) {
-        if (st.board.m_selected_tile) {
-          const auto p = SDL_FPoint{event.motion.x, event.motion.y};
-          const int tile_x =
-              (p.x - st.board.m_position.x) / st.board.m_tile_width;
-          const int tile_y =
-              (p.y - st.board.m_position.y) / st.board.m_tile_height;
-
-          if (!is_move_valid(st, tile_x, tile_y))
-            return;
-
-          auto tile_type = st.board.m_selected_tile->m_type;
-          if ((tile_type == TileType::None) ||
-              (tile_type == TileType::Equipment)) {
-            if (st.m_next_tile.m_type != TileType::None) {
-              if (tile_type == TileType::Equipment) {
-                st.m_eq_count++;
-                add_log_message(
-                    std::format(
-                        "Knights equipment gathered! You've got {} pieces.",
-                        st.m_eq_count)
-                        .c_str());
-              }
-
-              std::erase_if(st.board.m_valid_moves,
-                            [tile_x, tile_y](const SDL_Point &p) -> bool {
-                              return p.x == tile_x && p.y == tile_y;
-                            });
-
-              SDL_FRect drawn_tile_rect = st.m_next_tile.m_rect;
-              st.m_next_tile.m_rect = st.board.m_selected_tile->m_rect;
-              *st.board.m_selected_tile = st.m_next_tile;
-              st.m_next_tile.m_type = TileType::None;
-              st.board.add_valid_moves_from_tile(tile_x, tile_y);
-
-              if (st.board.m_draw_pile.empty())
-                return;
-
-              st.m_next_tile = st.board.m_draw_pile.back();
-              st.m_next_tile.m_rect = drawn_tile_rect;
-              st.board.m_draw_pile.pop_back();
-
-              board_changed = true;
-            }
-          }
-        }
+        // Click has to act on the tile under the button, not on the last
+        // coalesced motion position
+        st.m_hovered = cell_at(snapshot.board,
+                               SDL_FPoint{event.button.x, event.button.y});
+        pointer_moved = false;
+
+        if (st.m_hovered)
+          send(logic, Command{CommandType::Place,
+                              static_cast<uint8_t>(st.m_hovered->x),
+                              static_cast<uint8_t>(st.m_hovered->y),
+                              timestamp});
       } else if (event.button.button == SDL_BUTTON_RIGHT) {
-        st.m_next_tile.rotate();
+        send(logic, Command{CommandType::Rotate, 0, 0, timestamp});
       }
     }
   }
 
-  if (board_changed) {
-    st.board.recalculate_end_tiles();
-    if (st.board.m_reached_end) {
-      st.m_game_won = true;
-      return;
-    }
-  }
-
-  while (st.m_next_tile.m_type == TileType::Dragon) {
-    uint8_t x = get_random();
-    uint8_t y = 1 + get_random();
-    auto &random_tile = st.board.get_tile(x, y);
-
-    if (random_tile.m_type != TileType::Dragon) {
-      add_log_message(std::format("Dragon lands on tile {}, {}", x, y).c_str());
-
-      if (random_tile.m_type == TileType::Road) {
-        if (st.m_eq_count > 0) {
-          st.m_eq_count--;
-          add_log_message(std::format("Dragon was defeated using Knight's "
-                                      "Equipment. Pieces left: {}",
-                                      st.m_eq_count)
-                              .c_str());
-          break;
-        }
-      } else if (random_tile.m_type == TileType::Equipment) {
-        random_tile.m_type = TileType::None;
-        add_log_message(
-            std::format(
-                "Dragon was defeated using Knight's Equipment from the board")
-                .c_str());
-        break;
-      }
-      SDL_FRect drawn_tile_rect = st.m_next_tile.m_rect;
-      st.m_next_tile.m_rect = random_tile.m_rect;
-      random_tile = st.m_next_tile;
-      st.m_next_tile.m_type = TileType::None;
-
-      if (st.board.m_draw_pile.empty())
-        return;
+  if (pointer_moved)
+    st.m_hovered = cell_at(snapshot.board, pointer);
+}
 
-      st.m_next_tile = st.board.m_draw_pile.back();
-      st.m_next_tile.m_rect = drawn_tile_rect;
-      st.board.m_draw_pile.pop_back();
+void update_replay(State &st, ReplayViewer &viewer, Game &game,
+                   double elapsed_seconds) {
+  TRACE_ZONE("update_replay");
 
-      board_changed = true;
-    }
+  SDL_Event event;
+  while (SDL_PollEvent(&event)) {
+    if (event.type == SDL_EVENT_QUIT)
+      st.m_running = false;
+    else if ((event.type == SDL_EVENT_KEY_DOWN) &&
+             (event.key.key == SDLK_ESCAPE))
+      st.m_running = false;
+    else
+      viewer.handle_event(event);
   }
 
-  if (board_changed) {
-    st.board.update_valid_moves();
-    if (st.board.m_valid_moves.empty()) {
-      st.m_game_over = true;
-      return;
-    }
-
-    st.board.recalculate_end_tiles();
-    if (st.board.m_reached_end)
-      st.m_game_won = true;
-
-    st.board.recalculate_reachable_tiles();
-
-    if (!st.board.can_reach_end())
-      st.m_game_over = true;
-  }
+  viewer.update(game, elapsed_seconds);
 }
 
 void render_text(SDL_Renderer *r, const char *text, TTF_Font *font, int x,
                  int y, SDL_Color &c) {
+  TRACE_ZONE("render_text");
+
   SDL_SetRenderDrawColor(r, c.r, c.g, c.b, c.a);
   auto text_surface = TTF_RenderText_Solid(font, text, 0, c);
   auto text_texture = SDL_CreateTextureFromSurface(r, text_surface);
@@ -268,18 +165,62 @@ void render_text(SDL_Renderer *r, const char *text, TTF_Font *font, int x,
   SDL_DestroyTexture(text_texture);
 }
 
-void render_game_log(SDL_Renderer *r, const SDL_FPoint &initial_position,
-                     TTF_Font *font) {
+void render_game_log(SDL_Renderer *r, const std::vector<std::string> &log,
+                     const SDL_FPoint &initial_position, TTF_Font *font) {
   SDL_Color white = {0xFF, 0xFF, 0xFF, 0xFF};
-  for (size_t i{0}; auto &message : game_log) {
+  for (size_t i{0}; auto &message : log) {
     render_text(r, message.c_str(), font, initial_position.x,
                 initial_position.y + (20.0f * i), white);
     ++i;
   }
 }
 
-int main() {
+int main(int argc, char **argv) {
   State state{};
+  int wall_games{0};
+  float wall_rate{4.0f};
+  bool rate_given{false};
+  std::optional<ReplayViewer> viewer;
+
+  for (int i{1}; i < argc; ++i) {
+    const std::string_view arg{argv[i]};
+    if (arg == "--wall") {
+      wall_games = 64;
+      // The count is optional, anything that isn't another option is one
+      if ((i + 1 < argc) && !std::string_view{argv[i + 1]}.starts_with("--")) {
+        char *end{nullptr};
+        const long games = std::strtol(argv[++i], &end, 10);
+        if ((*end != '\0') || (games <= 0) || (games > INT_MAX)) {
+          SDL_Log("--wall needs a positive game count, got %s", argv[i]);
+          return 1;
+        }
+        wall_games = static_cast<int>(games);
+      }
+    } else if ((arg == "--rate") && (i + 1 < argc)) {
+      char *end{nullptr};
+      wall_rate = std::strtof(argv[++i], &end);
+      if ((*end != '\0') || !(wall_rate > 0.0f)) {
+        SDL_Log("--rate needs a positive number of moves, got %s", argv[i]);
+        return 1;
+      }
+      rate_given = true;
+    } else if ((arg == "--replay") && (i + 1 < argc)) {
+      viewer.emplace();
+      if (!viewer->m_replay.load(argv[++i])) {
+        SDL_Log("Couldn't load replay %s", argv[i]);
+        return 1;
+      }
+    } else {
+      SDL_Log("Usage: %s [--wall [games]] [--rate moves_per_second] "
+              "[--replay file]",
+              argv[0]);
+      return 1;
+    }
+  }
+  if (rate_given && (wall_games == 0)) {
+    SDL_Log("--rate only applies to --wall");
+    return 1;
+  }
 
   int res_x = 1920;
   int res_y = 1080;
@@ -309,6 +250,7 @@ int main() {
   if (display_count > 0) {
     auto display_mode = SDL_GetCurrentDisplayMode(displays[0]);
     if (display_mode) {
+      state.latency.set_refresh_rate(display_mode->refresh_rate);
       if ((display_mode->w < res_x) || (display_mode->h < res_y)) {
         res_x = 1280;
         res_y = 720;
@@ -322,48 +264,104 @@ int main() {
     return 1;
   }
 
-  state.board.init(res_x, res_y);
+  if (wall_games > 0)
+    return run_wall(state.renderer, res_x, res_y, wall_games, wall_rate);
+
+  trace_set_thread_name("main");
+  Game setup{};
+  setup.m_rng.seed(rd());
+  setup.board.init(res_x, res_y);
+  setup.m_next_tile.m_rect = drawn_tile_rect(setup.board);
   const SDL_FPoint game_log_pos =
-      SDL_FPoint{state.board.m_position.x + state.board.m_board_rect.w + 20.0f,
-                 state.board.m_position.y};
-  new_game(state);
+      SDL_FPoint{setup.board.m_position.x + setup.board.m_board_rect.w + 20.0f,
+                 setup.board.m_position.y};
+
+  // The viewer is cheap enough to seek on the main thread, normal games run
+  // their rules on the logic thread and are drawn from its snapshots
+  std::optional<GameThread> logic;
+  Game replay_game{};
+  GameSnapshot replay_snapshot{};
+  if (viewer) {
+    replay_game = setup;
+    viewer->m_timeline = SDL_FRect{10.0f, res_y - 35.0f, res_x - 20.0f, 20.0f};
+  } else {
+    logic.emplace(setup);
+  }
+  uint64_t last_input_ns{0};
 
   const char *text = "Dragons Aside";
+  const char *help_text =
+      viewer ? "Space to play/pause, Left/Right to step, Up/Down to change "
+               "speed, click the timeline to seek"
+             : "Left click to place a tile on board, Right to rotate, N to "
+               "restart game, L to log input latency";
   SDL_Color white = {0xFF, 0xFF, 0xFF, 0xFF};
+  uint64_t last_frame_ns = SDL_GetTicksNS();
 
   while (state.m_running) {
-    update(state);
+    TRACE_ZONE("frame");
+    const uint64_t frame_ns = SDL_GetTicksNS();
+    if (viewer) {
+      update_replay(state, *viewer, replay_game,
+                    (frame_ns - last_frame_ns) / 1e9);
+      replay_snapshot.capture(replay_game);
+    } else {
+      update(state, *logic);
+      if (logic->acquire() &&
+          (logic->snapshot().m_input_ns > last_input_ns)) {
+        last_input_ns = logic->snapshot().m_input_ns;
+        state.latency.input(last_input_ns);
+      }
+    }
+    last_frame_ns = frame_ns;
+    const auto &snapshot = viewer ? replay_snapshot : logic->snapshot();
 
     SDL_SetRenderDrawColorFloat(state.renderer, 0, 0, 0,
                                 SDL_ALPHA_OPAQUE_FLOAT);
     SDL_RenderClear(state.renderer);
 
-    state.board.render(state.renderer);
+    snapshot.board.render(state.renderer);
+    if (state.m_hovered)
+      snapshot.board.render_selection(state.renderer, state.m_hovered->x,
+                                      state.m_hovered->y);
 
-    if (state.m_game_won) {
+    if (snapshot.m_game_won) {
       render_text(state.renderer, "Game Won! Contratulations!", state.font, 800,
                   400, white);
-      render_text(state.renderer, "Press N to start new game", state.font, 800,
-                  430, white);
-    } else if (state.m_game_over) {
+      if (!viewer)
+        render_text(state.renderer, "Press N to start new game", state.font,
+                    800, 430, white);
+    } else if (snapshot.m_game_over) {
       render_text(state.renderer, "Game Over!", state.font, 800, 400, white);
-      render_text(state.renderer, "Press N to start new game", state.font, 800,
-                  430, white);
+      if (!viewer)
+        render_text(state.renderer, "Press N to start new game", state.font,
+                    800, 430, white);
     }
 
     render_text(state.renderer, text, state.font, 10, 10, white);
-    render_text(state.renderer,
-                "Left click to place a tile on board, Right to rotate, N to "
-                "restart game",
-                state.font, 10, 30, white);
+    render_text(state.renderer, help_text, state.font, 10, 30, white);
     render_text(state.renderer, "Drawn tile:", state.font, 10, 50, white);
 
-    render_game_log(state.renderer, game_log_pos, state.font);
+    render_game_log(state.renderer, snapshot.m_log, game_log_pos, state.font);
 
-    state.m_next_tile.render(state.renderer);
+    snapshot.m_next_tile.render(state.renderer);
+
+    if (viewer) {
+      viewer->render(state.renderer);
+      render_text(state.renderer,
+                  std::format("Turn {} / {}, {} turns/s{}", viewer->turn(),
+                              viewer->m_replay.turn_count() - 1,
+                              viewer->m_speed,
+                              viewer->m_playing ? "" : ", paused")
+                      .c_str(),
+                  state.font, 10, res_y - 60, white);
+    }
 
     SDL_RenderPresent(state.renderer);
+    state.latency.presented(SDL_GetTicksNS());
   }
 
+  state.latency.report();
+
   return 0;
 }
@@ -0,0 +1,245 @@
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <utility>
+#include <vector>
+
+#include "board.hpp"
+#include "game.hpp"
+#include "ntuple.hpp"
+#include "tile.hpp"
+#include "trace.hpp"
+
+namespace {
+// Square windows see the whole tile: empty, equipment, dragon or one of the
+// 15 road masks
+constexpr uint32_t square_codes = 18;
+constexpr uint32_t square_table = square_codes * square_codes *
+                                  square_codes * square_codes;
+// Runs only see whether a road connects along them, which keeps the tables
+// small enough to fill from self-play
+constexpr uint32_t line_codes = 7;
+constexpr uint32_t line_table = line_codes * line_codes * line_codes *
+                                line_codes;
+constexpr uint32_t max_equipment = 3;
+constexpr uint32_t max_pile_roads = 21;
+constexpr uint32_t max_pile_dragons = 16;
+
+constexpr uint32_t lines_offset =
+    NTupleEvaluator::m_square_count * square_table;
+constexpr uint32_t equipment_offset =
+    lines_offset + (NTupleEvaluator::m_line_count * line_table);
+constexpr uint32_t pile_offset = equipment_offset + max_equipment + 1;
+constexpr uint32_t next_tile_offset =
+    pile_offset + ((max_pile_roads + 1) * (max_pile_dragons + 1));
+constexpr uint32_t weight_count = next_tile_offset + square_codes;
+
+// File layout, native byte order: magic, version, weight count, weights
+constexpr char weights_magic[4] = {'D', 'A', 'N', 'T'};
+constexpr uint32_t weights_version = 1;
+
+// Codes for every tile type and road mask, indexed by type << 4 | mask
+struct CellCodes {
+  std::array<uint8_t, 64> m_square{};
+  std::array<uint8_t, 64> m_row{};
+  std::array<uint8_t, 64> m_column{};
+};
+
+constexpr CellCodes make_cell_codes() {
+  CellCodes codes;
+  for (uint8_t mask{0}; mask < 16; ++mask) {
+    const uint8_t road = (static_cast<uint8_t>(TileType::Road) << 4) | mask;
+    const uint8_t equipment =
+        (static_cast<uint8_t>(TileType::Equipment) << 4) | mask;
+    const uint8_t dragon = (static_cast<uint8_t>(TileType::Dragon) << 4) | mask;
+    codes.m_square.at(equipment) = codes.m_row.at(equipment) =
+        codes.m_column.at(equipment) = 1;
+    codes.m_square.at(dragon) = codes.m_row.at(dragon) =
+        codes.m_column.at(dragon) = 2;
+    if (mask == 0)
+      continue;
+    // Road bits in RoadConnections order are up, right, down, left
+    codes.m_square.at(road) = 2 + mask;
+    codes.m_row.at(road) = 3 + ((mask >> 3) & 1) + (mask & 2);
+    codes.m_column.at(road) = 3 + (mask & 1) + ((mask >> 1) & 2);
+  }
+  return codes;
+}
+
+constexpr CellCodes cell_codes = make_cell_codes();
+
+uint8_t cell_key(const Tile &tile) {
+  return (static_cast<uint8_t>(tile.m_type) << 4) |
+         (tile.m_road_connections & 0xF);
+}
+
+float squash(float sum) { return 1.0f / (1.0f + std::exp(-sum)); }
+} // namespace
+
+NTupleEvaluator::NTupleEvaluator() : m_weights(weight_count, 0.0f) {}
+
+void NTupleEvaluator::features(const Game &game, Features &out) {
+  constexpr uint8_t w = Board::m_board_width;
+  constexpr uint8_t h = Board::m_board_height;
+  std::array<uint8_t, Board::m_board_size> squares;
+  std::array<uint8_t, Board::m_board_size> rows;
+  std::array<uint8_t, Board::m_board_size> columns;
+  for (uint8_t y{0}; y < h; ++y) {
+    for (uint8_t x{0}; x < w; ++x) {
+      const auto key = cell_key(game.board.get_tile(x, y));
+      const size_t cell = (y * w) + x;
+      squares.at(cell) = cell_codes.m_square.at(key);
+      rows.at(cell) = cell_codes.m_row.at(key);
+      columns.at(cell) = cell_codes.m_column.at(key);
+    }
+  }
+
+  size_t f{0};
+  for (uint8_t y{0}; y + 1 < h; ++y) {
+    for (uint8_t x{0}; x + 1 < w; ++x) {
+      const size_t cell = (y * w) + x;
+      const uint32_t index =
+          (((((squares.at(cell) * square_codes) + squares.at(cell + 1)) *
+             square_codes) +
+            squares.at(cell + w)) *
+           square_codes) +
+          squares.at(cell + w + 1);
+      out.at(f) = (f * square_table) + index;
+      ++f;
+    }
+  }
+
+  uint32_t offset = lines_offset;
+  for (uint8_t y{0}; y < h; ++y) {
+    for (uint8_t x{0}; x + 3 < w; ++x) {
+      const size_t cell = (y * w) + x;
+      const uint32_t index =
+          (((((rows.at(cell) * line_codes) + rows.at(cell + 1)) *
+             line_codes) +
+            rows.at(cell + 2)) *
+           line_codes) +
+          rows.at(cell + 3);
+      out.at(f++) = offset + index;
+      offset += line_table;
+    }
+  }
+  for (uint8_t x{0}; x < w; ++x) {
+    for (uint8_t y{0}; y + 3 < h; ++y) {
+      const size_t cell = (y * w) + x;
+      const uint32_t index =
+          (((((columns.at(cell) * line_codes) + columns.at(cell + w)) *
+             line_codes) +
+            columns.at(cell + (2 * w))) *
+           line_codes) +
+          columns.at(cell + (3 * w));
+      out.at(f++) = offset + index;
+      offset += line_table;
+    }
+  }
+
+  uint32_t pile_roads{0};
+  uint32_t pile_dragons{0};
+  for (const auto &tile : game.board.m_draw_pile) {
+    pile_roads += tile.m_type == TileType::Road;
+    pile_dragons += tile.m_type == TileType::Dragon;
+  }
+  out.at(f++) = equipment_offset +
+                std::min<uint32_t>(game.m_eq_count, max_equipment);
+  out.at(f++) = pile_offset +
+                (std::min(pile_roads, max_pile_roads) *
+                 (max_pile_dragons + 1)) +
+                std::min(pile_dragons, max_pile_dragons);
+  out.at(f++) =
+      next_tile_offset + cell_codes.m_square.at(cell_key(game.m_next_tile));
+}
+
+float NTupleEvaluator::evaluate(const Features &features) const {
+  float sum{0.0f};
+  for (const auto index : features)
+    sum += m_weights[index];
+  return squash(sum);
+}
+
+float NTupleEvaluator::evaluate(const Game &game) const {
+  Features f;
+  features(game, f);
+  return evaluate(f);
+}
+
+void NTupleEvaluator::train(const Features &features, float target,
+                            float rate) {
+  const float step = rate * (target - evaluate(features));
+  for (const auto index : features)
+    m_weights[index] += step;
+}
+
+bool NTupleEvaluator::best_placement(const Game &game, Rng &rng,
+                                     Placement &out) const {
+  TRACE_ZONE("NTupleEvaluator::best_placement");
+
+  Game::Placements placements;
+  const auto count = game.legal_placements(placements);
+  if (count == 0)
+    return false;
+
+  float best_value{-1.0f};
+  size_t ties{0};
+  Game child;
+  for (size_t i{0}; i < count; ++i) {
+    const auto &placement = placements.at(i);
+    game.after_placement(placement, child);
+    const float value = child.m_game_won ? 1.0f : evaluate(child);
+
+    if (value > best_value) {
+      best_value = value;
+      ties = 1;
+      out = placement;
+    } else if ((value == best_value) &&
+               (std::uniform_int_distribution<size_t>(0, ties++)(rng) == 0)) {
+      out = placement;
+    }
+  }
+  return true;
+}
+
+bool NTupleEvaluator::save(const char *path) const {
+  FILE *file = fopen(path, "wb");
+  if (!file)
+    return false;
+
+  const uint32_t header[2] = {weights_version,
+                              static_cast<uint32_t>(m_weights.size())};
+  bool ok = fwrite(weights_magic, sizeof(weights_magic), 1, file) == 1;
+  ok = ok && (fwrite(header, sizeof(header), 1, file) == 1);
+  ok = ok && (fwrite(m_weights.data(), sizeof(float), m_weights.size(),
+                     file) == m_weights.size());
+
+  return (fclose(file) == 0) && ok;
+}
+
+bool NTupleEvaluator::load(const char *path) {
+  FILE *file = fopen(path, "rb");
+  if (!file)
+    return false;
+
+  // Any change to the tables changes the count, so old files are refused
+  char magic[4]{};
+  uint32_t header[2]{};
+  std::vector<float> weights(weight_count);
+  const bool ok =
+      (fread(magic, sizeof(magic), 1, file) == 1) &&
+      (memcmp(magic, weights_magic, sizeof(magic)) == 0) &&
+      (fread(header, sizeof(header), 1, file) == 1) &&
+      (header[0] == weights_version) && (header[1] == weight_count) &&
+      (fread(weights.data(), sizeof(float), weights.size(), file) ==
+       weights.size());
+  fclose(file);
+
+  if (ok)
+    m_weights = std::move(weights);
+  return ok;
+}
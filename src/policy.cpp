@@ -0,0 +1,59 @@
+#include <cstdint>
+#include <random>
+
+#include "analysis.hpp"
+#include "game.hpp"
+#include "policy.hpp"
+#include "random.hpp"
+#include "trace.hpp"
+
+bool random_policy(const Game &game, Rng &rng, Placement &out) {
+  Game::Placements placements;
+  const auto count = game.legal_placements(placements);
+  if (count == 0)
+    return false;
+
+  out = placements.at(std::uniform_int_distribution<size_t>(0, count - 1)(rng));
+  return true;
+}
+
+bool greedy_policy(const Game &game, Rng &rng, Placement &out) {
+  TRACE_ZONE("greedy_policy");
+
+  Game::Placements placements;
+  const auto count = game.legal_placements(placements);
+  if (count == 0)
+    return false;
+
+  int best_score{INT32_MAX};
+  size_t ties{0};
+  Game child;
+  for (size_t i{0}; i < count; ++i) {
+    const auto &placement = placements.at(i);
+    // Resolving dragons here would peek at the rolls
+    game.after_placement(placement, child);
+    const int score =
+        child.m_game_won ? -1 : min_roads_to_finish(child.board);
+
+    if (score < best_score) {
+      best_score = score;
+      ties = 1;
+      out = placement;
+    } else if ((score == best_score) &&
+               (std::uniform_int_distribution<size_t>(0, ties++)(rng) == 0)) {
+      out = placement;
+    }
+  }
+  return true;
+}
+
+bool play_game(Game &game, Policy policy, Rng &rng) {
+  TRACE_ZONE("play_game");
+
+  Placement placement;
+  while (!game.is_finished()) {
+    if (!policy(game, rng, placement) || !game.play(placement))
+      game.m_game_over = true;
+  }
+  return game.m_game_won;
+}
@@ -0,0 +1,189 @@
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <utility>
+#include <vector>
+
+#include "board.hpp"
+#include "game.hpp"
+#include "replay.hpp"
+#include "tile.hpp"
+
+namespace {
+// File layout, native byte order: magic, version, turn count, change count,
+// then the deltas and the changes they point into. Keyframes are rebuilt
+// on load.
+constexpr char replay_magic[4] = {'D', 'A', 'R', 'P'};
+constexpr uint32_t replay_version = 1;
+// Sanity limit for loading, a full game has less than 40 turns
+constexpr uint32_t max_turns = 1 << 24;
+
+constexpr uint8_t flag_won = 1 << 0;
+constexpr uint8_t flag_over = 1 << 1;
+
+bool valid_tile(uint8_t packed) {
+  return (packed >> 4) <= static_cast<uint8_t>(TileType::Road);
+}
+} // namespace
+
+void Replay::clear() {
+  m_keyframes.clear();
+  m_deltas.clear();
+  m_changes.clear();
+  m_last = Snapshot{};
+}
+
+Replay::Snapshot Replay::capture(const Game &game) {
+  Snapshot snapshot{};
+  for (uint8_t y{0}; y < Board::m_board_height; ++y) {
+    for (uint8_t x{0}; x < Board::m_board_width; ++x) {
+      snapshot.m_tiles.at((y * Board::m_board_width) + x) =
+          game.board.get_tile(x, y).packed();
+    }
+  }
+  snapshot.m_next_tile = game.m_next_tile.packed();
+  snapshot.m_eq_count = game.m_eq_count;
+  snapshot.m_flags = (game.m_game_won ? flag_won : 0) |
+                     (game.m_game_over ? flag_over : 0);
+  snapshot.m_pile_size = game.board.m_draw_pile.size();
+  return snapshot;
+}
+
+void Replay::record(const Game &game) {
+  const auto snapshot = capture(game);
+
+  Delta delta{};
+  delta.m_first_change = m_changes.size();
+  for (uint8_t cell{0}; cell < Board::m_board_size; ++cell) {
+    if (snapshot.m_tiles.at(cell) != m_last.m_tiles.at(cell))
+      m_changes.push_back(Change{cell, snapshot.m_tiles.at(cell)});
+  }
+  delta.m_change_count = m_changes.size() - delta.m_first_change;
+  delta.m_next_tile = snapshot.m_next_tile;
+  delta.m_eq_count = snapshot.m_eq_count;
+  delta.m_flags = snapshot.m_flags;
+  delta.m_pile_size = snapshot.m_pile_size;
+
+  if ((m_deltas.size() % m_keyframe_interval) == 0)
+    m_keyframes.push_back(snapshot);
+  m_deltas.push_back(delta);
+  m_last = snapshot;
+}
+
+void Replay::apply(const Delta &delta, Snapshot &snapshot) const {
+  for (uint32_t i{0}; i < delta.m_change_count; ++i) {
+    const auto &change = m_changes.at(delta.m_first_change + i);
+    snapshot.m_tiles.at(change.m_cell) = change.m_tile;
+  }
+  snapshot.m_next_tile = delta.m_next_tile;
+  snapshot.m_eq_count = delta.m_eq_count;
+  snapshot.m_flags = delta.m_flags;
+  snapshot.m_pile_size = delta.m_pile_size;
+}
+
+void Replay::seek(size_t turn, Game &game) const {
+  if (m_deltas.empty())
+    return;
+  if (turn >= m_deltas.size())
+    turn = m_deltas.size() - 1;
+
+  const size_t keyframe = turn / m_keyframe_interval;
+  auto snapshot = m_keyframes.at(keyframe);
+  for (size_t t{(keyframe * m_keyframe_interval) + 1}; t <= turn; ++t)
+    apply(m_deltas.at(t), snapshot);
+
+  for (uint8_t y{0}; y < Board::m_board_height; ++y) {
+    for (uint8_t x{0}; x < Board::m_board_width; ++x) {
+      game.board.get_tile(x, y).set_packed(
+          snapshot.m_tiles.at((y * Board::m_board_width) + x));
+    }
+  }
+  game.board.rebuild_valid_moves();
+  game.m_next_tile.set_packed(snapshot.m_next_tile);
+  game.m_eq_count = snapshot.m_eq_count;
+  game.m_game_won = snapshot.m_flags & flag_won;
+  game.m_game_over = snapshot.m_flags & flag_over;
+}
+
+bool Replay::save(const char *path) const {
+  static_assert(sizeof(Delta) == 12);
+  static_assert(sizeof(Change) == 2);
+
+  FILE *file = fopen(path, "wb");
+  if (!file)
+    return false;
+
+  const uint32_t header[3] = {replay_version,
+                              static_cast<uint32_t>(m_deltas.size()),
+                              static_cast<uint32_t>(m_changes.size())};
+  bool ok = fwrite(replay_magic, sizeof(replay_magic), 1, file) == 1;
+  ok = ok && (fwrite(header, sizeof(header), 1, file) == 1);
+  ok = ok && (fwrite(m_deltas.data(), sizeof(Delta), m_deltas.size(), file) ==
+              m_deltas.size());
+  ok = ok && (fwrite(m_changes.data(), sizeof(Change), m_changes.size(),
+                     file) == m_changes.size());
+
+  return (fclose(file) == 0) && ok;
+}
+
+bool Replay::load(const char *path) {
+  FILE *file = fopen(path, "rb");
+  if (!file)
+    return false;
+
+  char magic[4]{};
+  uint32_t header[3]{};
+  bool ok = (fread(magic, sizeof(magic), 1, file) == 1) &&
+            (memcmp(magic, replay_magic, sizeof(magic)) == 0) &&
+            (fread(header, sizeof(header), 1, file) == 1) &&
+            (header[0] == replay_version) && (header[1] <= max_turns) &&
+            (header[2] <= max_turns * Board::m_board_size);
+
+  // The counts have to match what's left of the file before anything is
+  // sized from them, a bad header mustn't make for a huge allocation
+  if (ok) {
+    const long data_start = ftell(file);
+    ok = (data_start >= 0) && (fseek(file, 0, SEEK_END) == 0);
+    const long file_end = ok ? ftell(file) : -1;
+    ok = ok && (file_end >= data_start) &&
+         (static_cast<uint64_t>(file_end - data_start) ==
+          (uint64_t{header[1]} * sizeof(Delta)) +
+              (uint64_t{header[2]} * sizeof(Change))) &&
+         (fseek(file, data_start, SEEK_SET) == 0);
+  }
+
+  std::vector<Delta> deltas;
+  std::vector<Change> changes;
+  if (ok) {
+    deltas.resize(header[1]);
+    changes.resize(header[2]);
+    ok = (fread(deltas.data(), sizeof(Delta), deltas.size(), file) ==
+          deltas.size()) &&
+         (fread(changes.data(), sizeof(Change), changes.size(), file) ==
+          changes.size());
+  }
+  fclose(file);
+
+  for (const auto &delta : deltas) {
+    ok = ok && (delta.m_first_change <= changes.size()) &&
+         (delta.m_change_count <= changes.size() - delta.m_first_change) &&
+         valid_tile(delta.m_next_tile);
+  }
+  for (const auto &change : changes)
+    ok = ok && (change.m_cell < Board::m_board_size) &&
+         valid_tile(change.m_tile);
+  if (!ok)
+    return false;
+
+  clear();
+  m_changes = std::move(changes);
+  m_deltas.reserve(deltas.size());
+  for (const auto &delta : deltas) {
+    apply(delta, m_last);
+    if ((m_deltas.size() % m_keyframe_interval) == 0)
+      m_keyframes.push_back(m_last);
+    m_deltas.push_back(delta);
+  }
+
+  return true;
+}
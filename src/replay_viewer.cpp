@@ -0,0 +1,107 @@
+#include <SDL3/SDL_events.h>
+#include <SDL3/SDL_keycode.h>
+#include <SDL3/SDL_mouse.h>
+#include <SDL3/SDL_rect.h>
+#include <SDL3/SDL_render.h>
+
+#include <algorithm>
+
+#include "game.hpp"
+#include "replay.hpp"
+#include "replay_viewer.hpp"
+#include "trace.hpp"
+
+void ReplayViewer::seek(double position) {
+  const double last =
+      m_replay.turn_count() > 0 ? m_replay.turn_count() - 1 : 0;
+  m_position = std::clamp(position, 0.0, last);
+}
+
+void ReplayViewer::seek_to_pointer(float x) {
+  if (m_timeline.w <= 0.0f)
+    return;
+  const double ratio = (x - m_timeline.x) / m_timeline.w;
+  seek(ratio * m_replay.turn_count());
+}
+
+void ReplayViewer::handle_event(const SDL_Event &event) {
+  if (event.type == SDL_EVENT_KEY_DOWN) {
+    switch (event.key.key) {
+    case SDLK_SPACE:
+      if (turn() + 1 >= m_replay.turn_count())
+        m_position = 0.0;
+      m_playing = !m_playing;
+      break;
+    case SDLK_RIGHT:
+      m_playing = false;
+      seek(turn() + 1);
+      break;
+    case SDLK_LEFT:
+      m_playing = false;
+      seek(static_cast<double>(turn()) - 1);
+      break;
+    case SDLK_PAGEDOWN:
+      seek(turn() + Replay::m_keyframe_interval);
+      break;
+    case SDLK_PAGEUP:
+      seek(static_cast<double>(turn()) - Replay::m_keyframe_interval);
+      break;
+    case SDLK_HOME:
+      seek(0.0);
+      break;
+    case SDLK_END:
+      seek(m_replay.turn_count());
+      break;
+    case SDLK_UP:
+      m_speed = std::min(m_speed * 2.0, m_max_speed);
+      break;
+    case SDLK_DOWN:
+      m_speed = std::max(m_speed * 0.5, m_min_speed);
+      break;
+    default:
+      break;
+    }
+  } else if ((event.type == SDL_EVENT_MOUSE_BUTTON_DOWN) &&
+             (event.button.button == SDL_BUTTON_LEFT)) {
+    const SDL_FPoint p{event.button.x, event.button.y};
+    if (SDL_PointInRectFloat(&p, &m_timeline)) {
+      m_dragging = true;
+      seek_to_pointer(p.x);
+    }
+  } else if (event.type == SDL_EVENT_MOUSE_BUTTON_UP) {
+    m_dragging = false;
+  } else if ((event.type == SDL_EVENT_MOUSE_MOTION) && m_dragging) {
+    seek_to_pointer(event.motion.x);
+  }
+}
+
+void ReplayViewer::update(Game &game, double elapsed_seconds) {
+  TRACE_ZONE("ReplayViewer::update");
+
+  if (m_playing && !m_dragging) {
+    seek(m_position + (m_speed * elapsed_seconds));
+    if (turn() + 1 >= m_replay.turn_count())
+      m_playing = false;
+  }
+
+  // However far the position jumped, one seek restores the turn
+  if (turn() != m_shown_turn) {
+    m_replay.seek(turn(), game);
+    m_shown_turn = turn();
+  }
+}
+
+void ReplayViewer::render(SDL_Renderer *r) const {
+  SDL_SetRenderDrawColor(r, 0x40, 0x40, 0x40, 0xFF);
+  SDL_RenderFillRect(r, &m_timeline);
+
+  const auto count = m_replay.turn_count();
+  if (count == 0)
+    return;
+
+  const float progress = static_cast<float>(turn() + 1) / count;
+  const SDL_FRect played{m_timeline.x, m_timeline.y, m_timeline.w * progress,
+                         m_timeline.h};
+  SDL_SetRenderDrawColor(r, 0xCC, 0xCC, 0xCC, 0xFF);
+  SDL_RenderFillRect(r, &played);
+}
@@ -5,49 +5,69 @@
 
 #include <array>
 #include <cstdint>
-#include <map>
 
+#include "geometry_batch.hpp"
 #include "tile.hpp"
 
+namespace {
+constexpr SDL_Color road_color{0x1F, 0x5F, 0x26, 0xFF};
+constexpr SDL_Color road_surface_color{0xf3, 0xd9, 0xab, 0xFF};
+constexpr SDL_Color dragon_color{0xFF, 0x0, 0x7F, 0xFF};
+constexpr SDL_Color equipment_color{0x0, 0xAA, 0x7F, 0xFF};
+constexpr SDL_Color border_color{0x18, 0x18, 0x18, 0xFF};
+
+constexpr std::array<RoadConnections, 4> connections{
+    RoadConnections::Up, RoadConnections::Right, RoadConnections::Down,
+    RoadConnections::Left};
+
+SDL_FRect connection_rect(const SDL_FRect &rect, RoadConnections con) {
+  switch (con) {
+  case RoadConnections::Up:
+    return SDL_FRect{rect.x + rect.w * 0.25f, rect.y, rect.w * 0.5f,
+                     rect.h * 0.75f};
+  case RoadConnections::Right:
+    return SDL_FRect{rect.x + rect.w * 0.25f, rect.y + rect.h * 0.25f,
+                     rect.w * 0.75f, rect.h * 0.5f};
+  case RoadConnections::Down:
+    return SDL_FRect{rect.x + rect.w * 0.25f, rect.y + rect.h * 0.25f,
+                     rect.w * 0.5f, rect.h * 0.75f};
+  case RoadConnections::Left:
+    return SDL_FRect{rect.x, rect.y + rect.h * 0.25f, rect.w * 0.75f,
+                     rect.h * 0.5f};
+  }
+  return rect;
+}
+
+void set_draw_color(SDL_Renderer *r, const SDL_Color &c) {
+  SDL_SetRenderDrawColor(r, c.r, c.g, c.b, c.a);
+}
+} // namespace
+
 bool Tile::has_road_connection(const RoadConnections &con) const {
   return !!(m_road_connections & static_cast<uint8_t>(con));
 }
 
 void Tile::render(SDL_Renderer *r) const {
-  const std::array<RoadConnections, 4> connections{
-      RoadConnections::Up, RoadConnections::Right, RoadConnections::Down,
-      RoadConnections::Left};
-  const std::map<RoadConnections, SDL_FRect> connection_rects{
-      {RoadConnections::Up, SDL_FRect{m_rect.x + m_rect.w * 0.25f, m_rect.y,
-                                      m_rect.w * 0.5f, m_rect.h * 0.75f}},
-      {RoadConnections::Right,
-       SDL_FRect{m_rect.x + m_rect.w * 0.25f, m_rect.y + m_rect.h * 0.25f,
-                 m_rect.w * 0.75f, m_rect.h * 0.5f}},
-      {RoadConnections::Down,
-       SDL_FRect{m_rect.x + m_rect.w * 0.25f, m_rect.y + m_rect.h * 0.25f,
-                 m_rect.w * 0.5f, m_rect.h * 0.75f}},
-      {RoadConnections::Left, SDL_FRect{m_rect.x, m_rect.y + m_rect.h * 0.25f,
-                                        m_rect.w * 0.75f, m_rect.h * 0.5f}}};
-
   switch (m_type) {
   case TileType::Road: {
-    SDL_SetRenderDrawColor(r, 0x1F, 0x5F, 0x26, 0xFF);
+    set_draw_color(r, road_color);
     SDL_RenderFillRect(r, &m_rect);
-    SDL_SetRenderDrawColor(r, 0xf3, 0xd9, 0xab, 0xFF);
+    set_draw_color(r, road_surface_color);
     for (auto &con : connections) {
-      if (!!(m_road_connections & static_cast<uint8_t>(con))) {
-        SDL_RenderFillRect(r, &connection_rects.at(con));
+      if (has_road_connection(con)) {
+        const auto con_rect = connection_rect(m_rect, con);
+        SDL_RenderFillRect(r, &con_rect);
       }
     }
     break;
   }
   case TileType::Dragon: {
-    SDL_SetRenderDrawColor(r, 0xFF, 0x0, 0x7F, 0xFF);
+    set_draw_color(r, dragon_color);
     SDL_RenderFillRect(r, &m_rect);
     break;
   }
   case TileType::Equipment: {
-    SDL_SetRenderDrawColor(r, 0x0, 0xAA, 0x7F, 0xFF);
+    set_draw_color(r, equipment_color);
     SDL_RenderFillRect(r, &m_rect);
     break;
   }
@@ -56,14 +76,44 @@ void Tile::render(SDL_Renderer *r) const {
   }
 
   // Border
-  SDL_SetRenderDrawColor(r, 0x18, 0x18, 0x18, 0xFF);
+  set_draw_color(r, border_color);
   SDL_RenderRect(r, &m_rect);
 }
 
+void Tile::render(GeometryBatch &batch) const {
+  switch (m_type) {
+  case TileType::Road: {
+    batch.add_rect(m_rect, road_color);
+    for (auto &con : connections) {
+      if (has_road_connection(con))
+        batch.add_rect(connection_rect(m_rect, con), road_surface_color);
+    }
+    break;
+  }
+  case TileType::Dragon:
+    batch.add_rect(m_rect, dragon_color);
+    break;
+  case TileType::Equipment:
+    batch.add_rect(m_rect, equipment_color);
+    break;
+  default:
+    break;
+  }
+
+  // Border
+  batch.add_outline(m_rect, 1.0f, border_color);
+}
+
+uint8_t Tile::packed() const {
+  return (static_cast<uint8_t>(m_type) << 4) | (m_road_connections & 0x0F);
+}
+
+void Tile::set_packed(uint8_t packed) {
+  m_type = static_cast<TileType>(packed >> 4);
+  m_road_connections = packed & 0x0F;
+}
+
 void Tile::rotate() {
-  const std::array<RoadConnections, 4> connections{
-      RoadConnections::Up, RoadConnections::Right, RoadConnections::Down,
-      RoadConnections::Left};
   uint8_t new_connections{0};
   for (auto &con : connections) {
     if (!!(m_road_connections & static_cast<uint8_t>(con))) {
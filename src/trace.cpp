@@ -0,0 +1,116 @@
+#include "trace.hpp"
+
+#ifdef DRAGONS_TRACE
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <mutex>
+#include <vector>
+
+namespace {
+struct TraceEvent {
+  const char *m_name;
+  uint64_t m_start_ns;
+  uint64_t m_duration_ns;
+};
+
+struct TraceBuffer {
+  static constexpr size_t m_capacity = 1 << 18;
+  std::array<TraceEvent, m_capacity> m_events;
+  // Written only by the owning thread, published with release so a reader
+  // sees complete events up to it
+  std::atomic<size_t> m_count{0};
+  std::atomic<const char *> m_thread_name{nullptr};
+  uint32_t m_thread_id{0};
+};
+
+std::mutex buffers_mutex;
+std::vector<TraceBuffer *> buffers;
+const auto trace_epoch = std::chrono::steady_clock::now();
+
+uint64_t now_ns() {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+             std::chrono::steady_clock::now() - trace_epoch)
+      .count();
+}
+
+TraceBuffer &thread_buffer() {
+  // Buffers are never freed so zones of finished threads still get written
+  thread_local TraceBuffer *buffer = [] {
+    auto *b = new TraceBuffer;
+    std::lock_guard lock{buffers_mutex};
+    b->m_thread_id = buffers.size() + 1;
+    buffers.push_back(b);
+    return b;
+  }();
+  return *buffer;
+}
+} // namespace
+
+TraceZone::TraceZone(const char *name) : m_name{name}, m_start_ns{now_ns()} {}
+
+TraceZone::~TraceZone() {
+  const uint64_t end_ns = now_ns();
+  auto &buffer = thread_buffer();
+  const auto index = buffer.m_count.load(std::memory_order_relaxed);
+  if (index >= TraceBuffer::m_capacity)
+    return;
+
+  buffer.m_events[index] = TraceEvent{m_name, m_start_ns, end_ns - m_start_ns};
+  buffer.m_count.store(index + 1, std::memory_order_release);
+}
+
+void trace_set_thread_name(const char *name) {
+  thread_buffer().m_thread_name.store(name, std::memory_order_release);
+}
+
+bool trace_write_json(const char *path) {
+  FILE *file = fopen(path, "w");
+  if (!file)
+    return false;
+
+  std::vector<TraceBuffer *> snapshot;
+  {
+    std::lock_guard lock{buffers_mutex};
+    snapshot = buffers;
+  }
+
+  fprintf(file, "{\"traceEvents\":[\n");
+  bool first{true};
+  for (auto *buffer : snapshot) {
+    const auto *thread_name =
+        buffer->m_thread_name.load(std::memory_order_acquire);
+    if (thread_name) {
+      fprintf(file,
+              "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,"
+              "\"tid\":%u,\"args\":{\"name\":\"%s\"}}",
+              first ? "" : ",\n", buffer->m_thread_id, thread_name);
+      first = false;
+    }
+
+    const auto count = buffer->m_count.load(std::memory_order_acquire);
+    for (size_t i{0}; i < count; ++i) {
+      const auto &event = buffer->m_events[i];
+      fprintf(file,
+              "%s{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%u,"
+              "\"ts\":%.3f,\"dur\":%.3f}",
+              first ? "" : ",\n", event.m_name, buffer->m_thread_id,
+              event.m_start_ns / 1000.0, event.m_duration_ns / 1000.0);
+      first = false;
+    }
+  }
+  fprintf(file, "\n],\"displayTimeUnit\":\"ns\"}\n");
+
+  return fclose(file) == 0;
+}
+
+#else
+
+void trace_set_thread_name(const char *) {}
+
+bool trace_write_json(const char *) { return false; }
+
+#endif // DRAGONS_TRACE
@@ -0,0 +1,174 @@
+#include <SDL3/SDL.h>
+#include <SDL3/SDL_events.h>
+#include <SDL3/SDL_keycode.h>
+#include <SDL3/SDL_rect.h>
+#include <SDL3/SDL_render.h>
+#include <SDL3/SDL_timer.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <random>
+#include <stop_token>
+#include <thread>
+#include <vector>
+
+#include "game.hpp"
+#include "geometry_batch.hpp"
+#include "policy.hpp"
+#include "random.hpp"
+#include "trace.hpp"
+#include "wall.hpp"
+
+namespace {
+constexpr uint64_t ns_per_second = 1'000'000'000;
+// Finished boards stay on screen for a moment before the next game starts
+constexpr uint64_t restart_delay_ns = ns_per_second;
+
+struct WallGame {
+  std::mutex m_mutex;
+  Game game;
+  Rng m_policy_rng;
+  uint64_t m_next_step_ns{0};
+};
+
+// Picks the column count that gives the biggest boards for the window
+SDL_Point grid_size(int res_x, int res_y, int game_count) {
+  SDL_Point best{1, game_count};
+  float best_tile{0.0f};
+
+  for (int cols{1}; cols <= game_count; ++cols) {
+    const int rows = (game_count + cols - 1) / cols;
+    const float tile =
+        std::min(static_cast<float>(res_x) / cols / Board::m_board_width,
+                 static_cast<float>(res_y) / rows / Board::m_board_height);
+    if (tile > best_tile) {
+      best_tile = tile;
+      best = SDL_Point{cols, rows};
+    }
+  }
+
+  return best;
+}
+
+void simulate(std::stop_token stop, std::vector<WallGame> &games,
+              size_t first, size_t stride, uint64_t step_interval_ns) {
+  trace_set_thread_name("wall simulation");
+  // Nothing notifies these, the wait only ends early on a stop request so
+  // closing the window doesn't wait out a long step interval
+  std::mutex sleep_mutex;
+  std::condition_variable_any sleep_wake;
+
+  while (!stop.stop_requested()) {
+    const uint64_t now = SDL_GetTicksNS();
+    uint64_t next_wake = now + std::max(step_interval_ns, ns_per_second / 100);
+
+    for (size_t i{first}; i < games.size(); i += stride) {
+      auto &wall_game = games.at(i);
+
+      if (now >= wall_game.m_next_step_ns) {
+        std::lock_guard lock{wall_game.m_mutex};
+        auto &game = wall_game.game;
+
+        if (game.is_finished()) {
+          game.new_game();
+        } else {
+          Placement placement;
+          if (random_policy(game, wall_game.m_policy_rng, placement))
+            game.play(placement);
+          else
+            game.m_game_over = true;
+        }
+
+        wall_game.m_next_step_ns =
+            now + (game.is_finished() ? restart_delay_ns : step_interval_ns);
+      }
+
+      next_wake = std::min(next_wake, wall_game.m_next_step_ns);
+    }
+
+    if (next_wake > now) {
+      const std::chrono::nanoseconds delay{next_wake - now};
+      std::unique_lock lock{sleep_mutex};
+      sleep_wake.wait_for(lock, stop, delay, [] { return false; });
+    }
+  }
+}
+} // namespace
+
+int run_wall(SDL_Renderer *r, int res_x, int res_y, int game_count,
+             float moves_per_second) {
+  const uint64_t step_interval_ns =
+      moves_per_second > 0.0f
+          ? static_cast<uint64_t>(ns_per_second / moves_per_second)
+          : 0;
+
+  std::random_device rd;
+  std::vector<WallGame> games(game_count);
+  const auto grid = grid_size(res_x, res_y, game_count);
+  const float cell_w = static_cast<float>(res_x) / grid.x;
+  const float cell_h = static_cast<float>(res_y) / grid.y;
+  const uint64_t start = SDL_GetTicksNS();
+
+  for (int i{0}; i < game_count; ++i) {
+    auto &wall_game = games.at(i);
+    wall_game.game.board.init(SDL_FRect{(i % grid.x) * cell_w,
+                                        (i / grid.x) * cell_h, cell_w,
+                                        cell_h});
+    wall_game.game.m_rng.seed(rd());
+    wall_game.m_policy_rng.seed(rd());
+    wall_game.game.new_game();
+    // Spread the moves over the interval so boards don't all change at once
+    wall_game.m_next_step_ns = start + (step_interval_ns * i / game_count);
+  }
+
+  const size_t thread_count =
+      std::clamp<size_t>(std::thread::hardware_concurrency(), 2, 64) - 1;
+  std::vector<std::jthread> threads;
+  for (size_t i{0}; i < thread_count; ++i)
+    threads.emplace_back(simulate, std::ref(games), i, thread_count,
+                         step_interval_ns);
+
+  SDL_SetRenderVSync(r, 1);
+  trace_set_thread_name("wall render");
+
+  GeometryBatch batch;
+  bool running{true};
+  while (running) {
+    SDL_Event event;
+    while (SDL_PollEvent(&event)) {
+      if (event.type == SDL_EVENT_QUIT)
+        running = false;
+      else if ((event.type == SDL_EVENT_KEY_DOWN) &&
+               (event.key.key == SDLK_ESCAPE))
+        running = false;
+    }
+
+    constexpr SDL_Color won_color{0x0, 0xFF, 0x0, 0x60};
+    constexpr SDL_Color lost_color{0xFF, 0x0, 0x0, 0x60};
+
+    TRACE_ZONE("wall frame");
+
+    batch.clear();
+    for (auto &wall_game : games) {
+      std::lock_guard lock{wall_game.m_mutex};
+      const auto &game = wall_game.game;
+
+      game.board.render(batch);
+      if (game.m_game_won)
+        batch.add_rect(game.board.m_board_rect, won_color);
+      else if (game.m_game_over)
+        batch.add_rect(game.board.m_board_rect, lost_color);
+    }
+
+    SDL_SetRenderDrawColorFloat(r, 0, 0, 0, SDL_ALPHA_OPAQUE_FLOAT);
+    SDL_RenderClear(r);
+    batch.draw(r);
+    SDL_RenderPresent(r);
+  }
+
+  return 0;
+}
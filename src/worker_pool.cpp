@@ -0,0 +1,82 @@
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <thread>
+
+#include "trace.hpp"
+#include "worker_pool.hpp"
+
+WorkerPool::WorkerPool(unsigned thread_count) {
+  if (thread_count == 0)
+    thread_count = std::max(1u, std::thread::hardware_concurrency());
+
+  for (unsigned i{1}; i < thread_count; ++i)
+    m_threads.emplace_back(&WorkerPool::worker_loop, this);
+}
+
+WorkerPool::~WorkerPool() {
+  {
+    std::lock_guard lock{m_mutex};
+    m_stopping = true;
+  }
+  m_start.notify_all();
+  for (auto &thread : m_threads)
+    thread.join();
+}
+
+void WorkerPool::run(size_t count, size_t chunk, Job job, void *context) {
+  if (count == 0)
+    return;
+
+  {
+    std::lock_guard lock{m_mutex};
+    m_job = job;
+    m_context = context;
+    m_count = count;
+    m_chunk = std::max<size_t>(chunk, 1);
+    m_next.store(0, std::memory_order_relaxed);
+    m_active = m_threads.size();
+    m_generation++;
+  }
+  m_start.notify_all();
+
+  work();
+
+  std::unique_lock lock{m_mutex};
+  m_done.wait(lock, [this] { return m_active == 0; });
+}
+
+void WorkerPool::worker_loop() {
+  uint64_t seen_generation{0};
+  trace_set_thread_name("worker");
+
+  while (true) {
+    {
+      std::unique_lock lock{m_mutex};
+      m_start.wait(lock, [this, seen_generation] {
+        return m_stopping || (m_generation != seen_generation);
+      });
+      if (m_stopping)
+        return;
+      seen_generation = m_generation;
+    }
+
+    work();
+
+    {
+      std::lock_guard lock{m_mutex};
+      m_active--;
+    }
+    m_done.notify_one();
+  }
+}
+
+void WorkerPool::work() {
+  // Items are claimed in chunks so a slow chunk doesn't hold up the others
+  while (true) {
+    const size_t begin = m_next.fetch_add(m_chunk, std::memory_order_relaxed);
+    if (begin >= m_count)
+      break;
+    m_job(m_context, begin, std::min(begin + m_chunk, m_count));
+  }
+}
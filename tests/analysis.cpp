@@ -0,0 +1,101 @@
+#include <cstdint>
+
+#include "analysis.hpp"
+#include "board.hpp"
+#include "check.hpp"
+#include "game.hpp"
+#include "tile.hpp"
+
+namespace {
+constexpr uint8_t up_down = static_cast<uint8_t>(RoadConnections::Up) |
+                            static_cast<uint8_t>(RoadConnections::Down);
+
+void set_tile(Game &game, uint8_t x, uint8_t y, TileType type,
+              uint8_t roads = 0) {
+  auto &tile = game.board.get_tile(x, y);
+  tile.m_type = type;
+  tile.m_road_connections = roads;
+}
+
+void give_roads(Game &game, int count) {
+  game.m_next_tile.m_type = TileType::Road;
+  game.board.m_draw_pile.clear();
+  for (int i{1}; i < count; ++i) {
+    Tile tile;
+    tile.m_type = TileType::Road;
+    game.board.m_draw_pile.push_back(tile);
+  }
+  // Dragons in the pile don't help
+  Tile dragon;
+  dragon.m_type = TileType::Dragon;
+  game.board.m_draw_pile.push_back(dragon);
+}
+
+// Start is the bottom left corner and finish the top right, so an empty
+// board needs a road on every tile of a shortest path, both ends included
+constexpr uint8_t empty_board_roads =
+    Board::m_board_width + Board::m_board_height - 1;
+
+void test_empty_board() {
+  Game game{};
+  CHECK(min_roads_to_finish(game.board) == empty_board_roads);
+
+  give_roads(game, empty_board_roads);
+  CHECK(count_roads_left(game) == empty_board_roads);
+  CHECK(!is_doomed(game));
+
+  give_roads(game, empty_board_roads - 1);
+  CHECK(is_doomed(game));
+}
+
+void test_placed_roads_are_free() {
+  Game game{};
+  for (uint8_t y{4}; y < Board::m_board_height; ++y)
+    set_tile(game, 0, y, TileType::Road, up_down);
+  CHECK(min_roads_to_finish(game.board) == empty_board_roads - 4);
+
+  // Equipment can still be built over
+  set_tile(game, 1, 4, TileType::Equipment);
+  CHECK(min_roads_to_finish(game.board) == empty_board_roads - 4);
+}
+
+void test_dragons() {
+  Game game{};
+  // A detour around one dragon costs nothing on an open board
+  set_tile(game, 0, 3, TileType::Dragon);
+  CHECK(min_roads_to_finish(game.board) == empty_board_roads);
+
+  for (uint8_t x{0}; x < Board::m_board_width; ++x)
+    set_tile(game, x, 3, TileType::Dragon);
+  CHECK(min_roads_to_finish(game.board) == unreachable_distance);
+  give_roads(game, Board::m_board_size);
+  CHECK(is_doomed(game));
+
+  Game start{};
+  set_tile(start, 0, Board::m_board_height - 1, TileType::Dragon);
+  CHECK(min_roads_to_finish(start.board) == unreachable_distance);
+}
+
+void test_roads_facing_away() {
+  Game game{};
+  // Two placed roads only join when one of them points at the other
+  set_tile(game, 0, 7, TileType::Road,
+           static_cast<uint8_t>(RoadConnections::Up));
+  set_tile(game, 1, 7, TileType::Road,
+           static_cast<uint8_t>(RoadConnections::Right));
+  set_tile(game, 0, 6, TileType::Dragon);
+  CHECK(min_roads_to_finish(game.board) == unreachable_distance);
+
+  set_tile(game, 1, 7, TileType::Road,
+           static_cast<uint8_t>(RoadConnections::Left));
+  CHECK(min_roads_to_finish(game.board) == empty_board_roads - 2);
+}
+} // namespace
+
+int main() {
+  test_empty_board();
+  test_placed_roads_are_free();
+  test_dragons();
+  test_roads_facing_away();
+  return check_result();
+}
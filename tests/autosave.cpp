@@ -0,0 +1,140 @@
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+#include "autosave.hpp"
+#include "board.hpp"
+#include "check.hpp"
+#include "game.hpp"
+#include "policy.hpp"
+#include "random.hpp"
+
+namespace {
+constexpr const char *save_path = "test.save";
+constexpr const char *broken_path = "test_broken.save";
+
+bool same_state(const Game &a, const Game &b) {
+  for (uint8_t y{0}; y < Board::m_board_height; ++y) {
+    for (uint8_t x{0}; x < Board::m_board_width; ++x) {
+      if (a.board.get_tile(x, y).packed() != b.board.get_tile(x, y).packed())
+        return false;
+    }
+  }
+  if (a.board.m_draw_pile.size() != b.board.m_draw_pile.size())
+    return false;
+  for (size_t i{0}; i < a.board.m_draw_pile.size(); ++i) {
+    if (a.board.m_draw_pile.at(i).packed() !=
+        b.board.m_draw_pile.at(i).packed())
+      return false;
+  }
+  return (a.m_next_tile.packed() == b.m_next_tile.packed()) &&
+         (a.m_eq_count == b.m_eq_count) && (a.m_game_over == b.m_game_over) &&
+         (a.m_game_won == b.m_game_won) &&
+         (a.board.m_valid_moves.size() == b.board.m_valid_moves.size());
+}
+
+void write_save(const Game &game, const std::vector<std::string> &log) {
+  // The destructor writes the last state handed over
+  Autosave autosave{save_path};
+  autosave.next().capture(game, log);
+  autosave.submit();
+}
+
+// Plays a few turns, saves, and checks the restored game plays out exactly
+// like the original, dragon rolls included
+void test_resume(uint32_t seed) {
+  Game game;
+  game.m_rng.seed(seed);
+  game.new_game();
+  Rng policy_rng{seed};
+  Placement placement;
+  for (int turn{0}; (turn < 5) && !game.is_finished() &&
+                    random_policy(game, policy_rng, placement);
+       ++turn)
+    game.play(placement);
+
+  const std::vector<std::string> log{"first line", "second line"};
+  write_save(game, log);
+  CHECK(!std::filesystem::exists(std::string{save_path} + ".tmp"));
+
+  SaveState saved;
+  CHECK(Autosave::load(save_path, saved));
+  CHECK(saved.is_finished() == game.is_finished());
+  Game resumed;
+  std::vector<std::string> resumed_log;
+  saved.restore(resumed, resumed_log);
+  CHECK(resumed_log == log);
+  CHECK(same_state(game, resumed));
+
+  // Valid moves are rebuilt in another order, so both play the placements
+  // picked on the original
+  while (!game.is_finished() && random_policy(game, policy_rng, placement)) {
+    CHECK(game.play(placement));
+    CHECK(resumed.play(placement));
+    CHECK(same_state(game, resumed));
+  }
+  CHECK(resumed.is_finished() == game.is_finished());
+}
+
+std::vector<uint8_t> read_file(const char *path) {
+  std::vector<uint8_t> bytes;
+  FILE *file = fopen(path, "rb");
+  if (!file)
+    return bytes;
+  int c;
+  while ((c = fgetc(file)) != EOF)
+    bytes.push_back(static_cast<uint8_t>(c));
+  fclose(file);
+  return bytes;
+}
+
+bool loads(const std::vector<uint8_t> &bytes) {
+  FILE *file = fopen(broken_path, "wb");
+  if (!file)
+    return false;
+  if (!bytes.empty())
+    fwrite(bytes.data(), 1, bytes.size(), file);
+  fclose(file);
+
+  SaveState state;
+  const bool ok = Autosave::load(broken_path, state);
+  std::remove(broken_path);
+  return ok;
+}
+
+void test_broken_files() {
+  Game game;
+  game.m_rng.seed(1);
+  game.new_game();
+  write_save(game, {"line"});
+  const auto bytes = read_file(save_path);
+  CHECK(loads(bytes));
+
+  CHECK(!loads({}));
+  auto magic = bytes;
+  magic.at(0) = 'X';
+  CHECK(!loads(magic));
+
+  // A crash can't leave a half written save, but a copy can be cut short
+  for (size_t size{0}; size < bytes.size(); ++size)
+    CHECK(!loads(std::vector<uint8_t>(bytes.begin(), bytes.begin() + size)));
+
+  // First board tile, right after magic, version and rng state
+  auto tile = bytes;
+  tile.at(12) = 0xF0;
+  CHECK(!loads(tile));
+
+  SaveState state;
+  CHECK(!Autosave::load("missing.save", state));
+  std::remove(save_path);
+}
+} // namespace
+
+int main() {
+  for (uint32_t seed{1}; seed <= 20; ++seed)
+    test_resume(seed);
+  test_broken_files();
+  return check_result();
+}
@@ -0,0 +1,21 @@
+#ifndef _CHECK_HPP
+#define _CHECK_HPP
+
+#include <cstdio>
+
+// Tests are plain executables run by ctest. A failed CHECK prints where it
+// was and carries on, main returns check_result() at the end.
+inline int check_failures = 0;
+
+#define CHECK(condition)                                                       \
+  do {                                                                         \
+    if (!(condition)) {                                                        \
+      fprintf(stderr, "%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__,         \
+              #condition);                                                     \
+      ++check_failures;                                                        \
+    }                                                                          \
+  } while (false)
+
+inline int check_result() { return check_failures == 0 ? 0 : 1; }
+
+#endif // _CHECK_HPP
@@ -0,0 +1,159 @@
+#include <cstdint>
+#include <cstring>
+#include <random>
+#include <vector>
+
+#include "check.hpp"
+#include "dragons_env.h"
+
+namespace {
+constexpr uint32_t env_count = 8;
+constexpr int step_count = 2000;
+
+struct Buffers {
+  std::vector<uint8_t> obs =
+      std::vector<uint8_t>(env_count * DA_OBS_SIZE);
+  std::vector<uint8_t> mask =
+      std::vector<uint8_t>(env_count * DA_ACTION_COUNT);
+  std::vector<uint32_t> actions = std::vector<uint32_t>(env_count);
+  std::vector<float> rewards = std::vector<float>(env_count);
+  std::vector<uint8_t> dones = std::vector<uint8_t>(env_count);
+};
+
+uint8_t plane(const uint8_t *obs, int plane, int cell) {
+  return obs[(plane * DA_CELL_COUNT) + cell];
+}
+
+// Every cell holds exactly one tile type, and only road tiles have road
+// connections. Leftover connections from an earlier game would show up on
+// empty and equipment cells here.
+void check_observation(const uint8_t *obs, const uint8_t *mask) {
+  for (int cell{0}; cell < DA_CELL_COUNT; ++cell) {
+    const int types = plane(obs, DA_PLANE_EMPTY, cell) +
+                      plane(obs, DA_PLANE_EQUIPMENT, cell) +
+                      plane(obs, DA_PLANE_DRAGON, cell) +
+                      plane(obs, DA_PLANE_ROAD, cell);
+    CHECK(types == 1);
+
+    if (!plane(obs, DA_PLANE_ROAD, cell) &&
+        !plane(obs, DA_PLANE_DRAGON, cell)) {
+      for (int con{0}; con < 4; ++con)
+        CHECK(plane(obs, DA_PLANE_ROAD_UP + con, cell) == 0);
+    }
+
+    for (int r{0}; r < 4; ++r) {
+      if (mask[(cell * 4) + r])
+        CHECK(plane(obs, DA_PLANE_VALID_MOVE, cell) == 1);
+    }
+  }
+}
+
+// Random legal action, or an illegal one if the game has none
+void pick_actions(Buffers &b, std::minstd_rand &rng) {
+  for (uint32_t i{0}; i < env_count; ++i) {
+    const uint8_t *mask = b.mask.data() + (i * DA_ACTION_COUNT);
+    std::vector<uint32_t> legal;
+    for (uint32_t a{0}; a < DA_ACTION_COUNT; ++a) {
+      if (mask[a])
+        legal.push_back(a);
+    }
+    b.actions.at(i) =
+        legal.empty() ? DA_ACTION_COUNT
+                      : legal.at(std::uniform_int_distribution<size_t>(
+                            0, legal.size() - 1)(rng));
+  }
+}
+
+void test_episodes() {
+  auto *batch = da_env_batch_create(env_count, 42, 2);
+  CHECK(batch != nullptr);
+  if (!batch)
+    return;
+  CHECK(da_env_batch_size(batch) == env_count);
+
+  Buffers b;
+  da_env_batch_reset(batch, b.obs.data(), b.mask.data());
+  std::minstd_rand rng{7};
+  int episodes{0};
+
+  for (int step{0}; step < step_count; ++step) {
+    pick_actions(b, rng);
+    da_env_batch_step(batch, b.actions.data(), b.obs.data(), b.mask.data(),
+                      b.rewards.data(), b.dones.data());
+
+    for (uint32_t i{0}; i < env_count; ++i) {
+      const float reward = b.rewards.at(i);
+      if (b.dones.at(i)) {
+        ++episodes;
+        CHECK((reward == DA_REWARD_WIN) || (reward == DA_REWARD_LOSS));
+      } else {
+        CHECK((reward == 0.0f) || (reward == DA_REWARD_ILLEGAL));
+      }
+      check_observation(b.obs.data() + (i * DA_OBS_SIZE),
+                        b.mask.data() + (i * DA_ACTION_COUNT));
+    }
+  }
+
+  // Enough games finished that restarted ones were checked too
+  CHECK(episodes > static_cast<int>(env_count));
+  da_env_batch_destroy(batch);
+}
+
+void test_illegal_action() {
+  auto *batch = da_env_batch_create(1, 3, 1);
+  CHECK(batch != nullptr);
+  if (!batch)
+    return;
+
+  Buffers b;
+  da_env_batch_reset(batch, b.obs.data(), b.mask.data());
+  const std::vector<uint8_t> before(b.obs.begin(),
+                                    b.obs.begin() + DA_OBS_SIZE);
+
+  b.actions.at(0) = DA_ACTION_COUNT;
+  da_env_batch_step(batch, b.actions.data(), b.obs.data(), nullptr,
+                    b.rewards.data(), b.dones.data());
+  CHECK(b.rewards.at(0) == DA_REWARD_ILLEGAL);
+  CHECK(b.dones.at(0) == 0);
+  CHECK(memcmp(before.data(), b.obs.data(), DA_OBS_SIZE) == 0);
+  da_env_batch_destroy(batch);
+}
+
+// Same seed and actions give the same games whatever the thread count
+void test_deterministic() {
+  auto *a = da_env_batch_create(env_count, 99, 1);
+  auto *c = da_env_batch_create(env_count, 99, 3);
+  CHECK((a != nullptr) && (c != nullptr));
+  if (!a || !c)
+    return;
+
+  Buffers ba;
+  Buffers bc;
+  da_env_batch_reset(a, ba.obs.data(), ba.mask.data());
+  da_env_batch_reset(c, bc.obs.data(), bc.mask.data());
+  CHECK(ba.obs == bc.obs);
+
+  std::minstd_rand rng{11};
+  for (int step{0}; step < 200; ++step) {
+    pick_actions(ba, rng);
+    bc.actions = ba.actions;
+    da_env_batch_step(a, ba.actions.data(), ba.obs.data(), ba.mask.data(),
+                      ba.rewards.data(), ba.dones.data());
+    da_env_batch_step(c, bc.actions.data(), bc.obs.data(), bc.mask.data(),
+                      bc.rewards.data(), bc.dones.data());
+    CHECK(ba.obs == bc.obs);
+    CHECK(ba.mask == bc.mask);
+    CHECK(ba.rewards == bc.rewards);
+  }
+
+  da_env_batch_destroy(a);
+  da_env_batch_destroy(c);
+}
+} // namespace
+
+int main() {
+  test_episodes();
+  test_illegal_action();
+  test_deterministic();
+  return check_result();
+}
@@ -0,0 +1,154 @@
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+#include "board.hpp"
+#include "check.hpp"
+#include "game.hpp"
+#include "policy.hpp"
+#include "random.hpp"
+#include "replay.hpp"
+
+namespace {
+constexpr const char *replay_path = "test.replay";
+constexpr const char *broken_path = "test_broken.replay";
+// Magic and the three header words
+constexpr size_t header_size = 16;
+// Turn count, then next tile right after the two change indices
+constexpr size_t turn_count_offset = 8;
+constexpr size_t first_next_tile_offset = header_size + 8;
+
+struct Turn {
+  std::vector<uint8_t> m_tiles;
+  uint8_t m_next_tile{0};
+  uint8_t m_eq_count{0};
+  bool m_over{false};
+  bool m_won{false};
+
+  explicit Turn(const Game &game)
+      : m_next_tile{game.m_next_tile.packed()}, m_eq_count{game.m_eq_count},
+        m_over{game.m_game_over}, m_won{game.m_game_won} {
+    for (uint8_t y{0}; y < Board::m_board_height; ++y) {
+      for (uint8_t x{0}; x < Board::m_board_width; ++x)
+        m_tiles.push_back(game.board.get_tile(x, y).packed());
+    }
+  }
+
+  bool operator==(const Turn &) const = default;
+};
+
+// Plays whole games into one replay, new games included, until it's long
+// enough to need a few keyframes
+std::vector<Turn> record(Replay &replay, uint32_t seed) {
+  Game game;
+  game.m_rng.seed(seed);
+  Rng policy_rng{seed};
+  std::vector<Turn> turns;
+
+  replay.clear();
+  while (turns.size() < 3 * Replay::m_keyframe_interval) {
+    game.new_game();
+    replay.record(game);
+    turns.emplace_back(game);
+    Placement placement;
+    while (!game.is_finished() &&
+           random_policy(game, policy_rng, placement)) {
+      game.play(placement);
+      replay.record(game);
+      turns.emplace_back(game);
+    }
+  }
+  return turns;
+}
+
+bool matches(const Replay &replay, const std::vector<Turn> &turns) {
+  if (replay.turn_count() != turns.size())
+    return false;
+
+  Game game;
+  // Backwards so every seek has to go through a keyframe
+  for (size_t i{turns.size()}; i-- > 0;) {
+    replay.seek(i, game);
+    if (!(Turn{game} == turns.at(i)))
+      return false;
+  }
+  return true;
+}
+
+std::vector<uint8_t> read_file(const char *path) {
+  std::vector<uint8_t> bytes;
+  FILE *file = fopen(path, "rb");
+  if (!file)
+    return bytes;
+  int c;
+  while ((c = fgetc(file)) != EOF)
+    bytes.push_back(static_cast<uint8_t>(c));
+  fclose(file);
+  return bytes;
+}
+
+bool loads(const std::vector<uint8_t> &bytes) {
+  FILE *file = fopen(broken_path, "wb");
+  if (!file)
+    return false;
+  if (!bytes.empty())
+    fwrite(bytes.data(), 1, bytes.size(), file);
+  fclose(file);
+
+  Replay replay;
+  const bool ok = replay.load(broken_path);
+  std::remove(broken_path);
+  return ok;
+}
+
+void test_round_trip() {
+  Replay replay;
+  const auto turns = record(replay, 5);
+  CHECK(matches(replay, turns));
+
+  CHECK(replay.save(replay_path));
+  Replay loaded;
+  CHECK(loaded.load(replay_path));
+  CHECK(matches(loaded, turns));
+}
+
+void test_broken_files() {
+  const auto bytes = read_file(replay_path);
+  CHECK(bytes.size() > header_size);
+  CHECK(loads(bytes));
+
+  CHECK(!loads({}));
+  auto truncated = bytes;
+  truncated.pop_back();
+  CHECK(!loads(truncated));
+
+  auto magic = bytes;
+  magic.at(0) = 'X';
+  CHECK(!loads(magic));
+
+  // Counts that don't fit the file are refused before anything is sized
+  // from them
+  auto counts = bytes;
+  const uint32_t turn_count = (1 << 24) - 1;
+  memcpy(counts.data() + turn_count_offset, &turn_count, sizeof(turn_count));
+  CHECK(!loads(counts));
+
+  auto change_tile = bytes;
+  change_tile.back() = 0xF0;
+  CHECK(!loads(change_tile));
+
+  auto next_tile = bytes;
+  next_tile.at(first_next_tile_offset) = 0xF0;
+  CHECK(!loads(next_tile));
+
+  CHECK(!Replay{}.load("missing.replay"));
+  std::remove(replay_path);
+}
+} // namespace
+
+int main() {
+  test_round_trip();
+  test_broken_files();
+  return check_result();
+}
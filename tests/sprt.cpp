@@ -0,0 +1,64 @@
+#include <cmath>
+
+#include "check.hpp"
+#include "sprt.hpp"
+
+namespace {
+bool near(double a, double b) { return std::abs(a - b) < 1e-9; }
+
+// Number of identical results it takes to reach a verdict
+int results_to_verdict(Sprt sprt, bool a_won, Verdict &verdict) {
+  for (int i{1}; i < 1000; ++i) {
+    verdict = sprt.add(a_won);
+    if (verdict != Verdict::Undecided)
+      return i;
+  }
+  return 0;
+}
+
+void test_bounds() {
+  const Sprt sprt{0.6, 0.05, 0.05};
+  CHECK(near(sprt.lower(), std::log(0.05 / 0.95)));
+  CHECK(near(sprt.upper(), std::log(0.95 / 0.05)));
+  CHECK(near(sprt.llr(), 0.0));
+
+  const Sprt uneven{0.6, 0.01, 0.1};
+  CHECK(near(uneven.lower(), std::log(0.1 / 0.99)));
+  CHECK(near(uneven.upper(), std::log(0.9 / 0.01)));
+}
+
+void test_steps() {
+  Sprt sprt{0.6, 0.05, 0.05};
+  sprt.add(true);
+  CHECK(near(sprt.llr(), std::log(1.2)));
+  sprt.add(false);
+  CHECK(near(sprt.llr(), std::log(1.2) + std::log(0.8)));
+}
+
+void test_verdicts() {
+  // A only wins cross the upper bound after ceil(upper / log(2 p1)) pairs
+  const Sprt sprt{0.6, 0.05, 0.05};
+  Verdict verdict{Verdict::Undecided};
+  CHECK(results_to_verdict(sprt, true, verdict) ==
+        static_cast<int>(std::ceil(sprt.upper() / std::log(1.2))));
+  CHECK(verdict == Verdict::AcceptH1);
+
+  CHECK(results_to_verdict(sprt, false, verdict) ==
+        static_cast<int>(std::ceil(sprt.lower() / std::log(0.8))));
+  CHECK(verdict == Verdict::AcceptH0);
+
+  // Even splits drift towards H0, the midpoint of H0 and H1 is above 0.5
+  Sprt even{0.6, 0.05, 0.05};
+  Verdict last{Verdict::Undecided};
+  for (int i{0}; (i < 10000) && (last == Verdict::Undecided); ++i)
+    last = even.add((i % 2) == 0);
+  CHECK(last == Verdict::AcceptH0);
+}
+} // namespace
+
+int main() {
+  test_bounds();
+  test_steps();
+  test_verdicts();
+  return check_result();
+}
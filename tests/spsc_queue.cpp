@@ -0,0 +1,73 @@
+#include <cstddef>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+#include "check.hpp"
+#include "spsc_queue.hpp"
+
+namespace {
+constexpr size_t queue_size = 8;
+
+void test_single_thread() {
+  SpscQueue<int, queue_size> queue;
+  std::vector<int> out;
+  auto collect = [&out](int value) { out.push_back(value); };
+
+  CHECK(queue.drain(collect) == 0);
+
+  // Goes round the ring a few times
+  int next{0};
+  for (int round{0}; round < 5; ++round) {
+    for (size_t i{0}; i < queue_size; ++i)
+      CHECK(queue.push(next++));
+    CHECK(!queue.push(-1));
+
+    out.clear();
+    CHECK(queue.drain(collect) == queue_size);
+    CHECK(out.size() == queue_size);
+    for (size_t i{0}; i < out.size(); ++i)
+      CHECK(out.at(i) == next - static_cast<int>(queue_size - i));
+  }
+
+  // A partly drained ring takes exactly as many as were taken out
+  for (size_t i{0}; i < queue_size / 2; ++i)
+    CHECK(queue.push(static_cast<int>(i)));
+  CHECK(queue.drain(collect) == queue_size / 2);
+  for (size_t i{0}; i < queue_size; ++i)
+    CHECK(queue.push(static_cast<int>(i)));
+  CHECK(!queue.push(-1));
+}
+
+void test_two_threads() {
+  constexpr uint32_t count = 200000;
+  SpscQueue<uint32_t, queue_size> queue;
+
+  std::thread producer{[&queue] {
+    for (uint32_t i{0}; i < count; ++i) {
+      while (!queue.push(i))
+        std::this_thread::yield();
+    }
+  }};
+
+  uint32_t expected{0};
+  bool in_order{true};
+  while (expected < count) {
+    queue.drain([&](uint32_t value) {
+      in_order = in_order && (value == expected);
+      ++expected;
+    });
+  }
+  producer.join();
+
+  CHECK(in_order);
+  CHECK(expected == count);
+  CHECK(queue.drain([](uint32_t) {}) == 0);
+}
+} // namespace
+
+int main() {
+  test_single_thread();
+  test_two_threads();
+  return check_result();
+}
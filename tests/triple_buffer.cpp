@@ -0,0 +1,79 @@
+#include <cstdint>
+#include <thread>
+
+#include "check.hpp"
+#include "triple_buffer.hpp"
+
+namespace {
+// Both halves are written separately, a torn read would see them differ
+struct Value {
+  uint64_t m_first{0};
+  uint64_t m_second{0};
+};
+
+void test_single_thread() {
+  TripleBuffer<Value> buffer;
+  CHECK(!buffer.acquire());
+
+  buffer.back() = Value{1, 1};
+  buffer.publish();
+  CHECK(buffer.acquire());
+  CHECK(buffer.front().m_first == 1);
+  CHECK(!buffer.acquire());
+  CHECK(buffer.front().m_first == 1);
+
+  // Values the reader missed are skipped, it gets the newest
+  for (uint64_t i{2}; i <= 4; ++i) {
+    buffer.back() = Value{i, i};
+    buffer.publish();
+  }
+  CHECK(buffer.acquire());
+  CHECK(buffer.front().m_first == 4);
+  CHECK(!buffer.acquire());
+
+  // The writer never gets the slot the reader is looking at
+  for (int i{0}; i < 8; ++i) {
+    CHECK(&buffer.back() != &buffer.front());
+    buffer.publish();
+    CHECK(&buffer.back() != &buffer.front());
+    buffer.acquire();
+  }
+}
+
+void test_two_threads() {
+  constexpr uint64_t count = 200000;
+  TripleBuffer<Value> buffer;
+
+  std::thread writer{[&buffer] {
+    for (uint64_t i{1}; i <= count; ++i) {
+      auto &value = buffer.back();
+      value.m_first = i;
+      value.m_second = i;
+      buffer.publish();
+    }
+  }};
+
+  uint64_t last{0};
+  bool in_order{true};
+  bool whole{true};
+  while (last < count) {
+    if (!buffer.acquire())
+      continue;
+    const auto &value = buffer.front();
+    whole = whole && (value.m_first == value.m_second);
+    in_order = in_order && (value.m_first > last);
+    last = value.m_first;
+  }
+  writer.join();
+
+  CHECK(whole);
+  CHECK(in_order);
+  CHECK(last == count);
+}
+} // namespace
+
+int main() {
+  test_single_thread();
+  test_two_threads();
+  return check_result();
+}
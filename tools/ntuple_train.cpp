@@ -0,0 +1,137 @@
+// Learns NTupleEvaluator weights from self-play with TD(0) on afterstates.
+// Every turn the bot picks the placement whose position scores best (or a
+// random one now and then), and the score of the position it picked the
+// turn before is moved towards the score of the new one. The last position
+// of a game is moved towards the result instead.
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string_view>
+
+#include "game.hpp"
+#include "ntuple.hpp"
+#include "policy.hpp"
+#include "random.hpp"
+
+namespace {
+struct TrainConfig {
+  float m_rate{0.002f};
+  float m_exploration{0.05f};
+};
+
+bool train_game(NTupleEvaluator &evaluator, const TrainConfig &config,
+                Game &game, Rng &rng) {
+  NTupleEvaluator::Features previous;
+  NTupleEvaluator::Features current;
+  bool has_previous{false};
+  Game after;
+  Placement placement;
+  std::uniform_real_distribution<float> chance{0.0f, 1.0f};
+
+  while (!game.is_finished()) {
+    const bool picked = chance(rng) < config.m_exploration
+                            ? random_policy(game, rng, placement)
+                            : evaluator.best_placement(game, rng, placement);
+    if (!picked)
+      break;
+
+    game.after_placement(placement, after);
+    NTupleEvaluator::features(after, current);
+    if (has_previous) {
+      const float target =
+          after.m_game_won ? 1.0f : evaluator.evaluate(current);
+      evaluator.train(previous, target, config.m_rate);
+    }
+    previous = current;
+    has_previous = true;
+
+    game.play(placement);
+  }
+
+  if (has_previous)
+    evaluator.train(previous, game.m_game_won ? 1.0f : 0.0f, config.m_rate);
+  return game.m_game_won;
+}
+
+int usage(const char *name) {
+  fprintf(stderr,
+          "Usage: %s [--games N] [--seed N] [--rate X] [--explore X] "
+          "[--report N] [--in file] [--out file]\n",
+          name);
+  return 1;
+}
+} // namespace
+
+int main(int argc, char **argv) {
+  uint64_t game_count{200'000};
+  // Far from the seeds dragons_tournament starts from, so a trained bot
+  // isn't measured on the deals it learned from
+  uint32_t seed{1u << 31};
+  uint64_t report_every{10'000};
+  const char *in_path{nullptr};
+  const char *out_path{"ntuple.weights"};
+  TrainConfig config;
+
+  for (int i{1}; i < argc; ++i) {
+    const std::string_view arg{argv[i]};
+    const bool has_value = i + 1 < argc;
+    if ((arg == "--games") && has_value)
+      game_count = std::strtoull(argv[++i], nullptr, 10);
+    else if ((arg == "--seed") && has_value)
+      seed = std::strtoul(argv[++i], nullptr, 10);
+    else if ((arg == "--rate") && has_value)
+      config.m_rate = std::strtof(argv[++i], nullptr);
+    else if ((arg == "--explore") && has_value)
+      config.m_exploration = std::strtof(argv[++i], nullptr);
+    else if ((arg == "--report") && has_value)
+      report_every = std::strtoull(argv[++i], nullptr, 10);
+    else if ((arg == "--in") && has_value)
+      in_path = argv[++i];
+    else if ((arg == "--out") && has_value)
+      out_path = argv[++i];
+    else
+      return usage(argv[0]);
+  }
+  if (report_every == 0)
+    return usage(argv[0]);
+
+  NTupleEvaluator evaluator;
+  if (in_path && !evaluator.load(in_path)) {
+    fprintf(stderr, "Couldn't load weights from %s\n", in_path);
+    return 1;
+  }
+
+  Rng rng{seed};
+  Game game;
+  uint64_t wins{0};
+  auto start = std::chrono::steady_clock::now();
+
+  for (uint64_t i{0}; i < game_count; ++i) {
+    game.m_rng.seed(seed + i);
+    game.new_game();
+    wins += train_game(evaluator, config, game, rng);
+
+    if (((i + 1) % report_every) == 0) {
+      const auto now = std::chrono::steady_clock::now();
+      const std::chrono::duration<double> elapsed = now - start;
+      printf("%10llu games, won %.2f%% of the last %llu, %.0f games/s\n",
+             static_cast<unsigned long long>(i + 1),
+             100.0 * wins / report_every,
+             static_cast<unsigned long long>(report_every),
+             report_every / elapsed.count());
+      fflush(stdout);
+      wins = 0;
+      start = now;
+    }
+  }
+
+  if (!evaluator.save(out_path)) {
+    fprintf(stderr, "Couldn't save weights to %s\n", out_path);
+    return 1;
+  }
+  printf("Weights saved to %s\n", out_path);
+  return 0;
+}
@@ -0,0 +1,287 @@
+// Counts every game state reachable from a seeded start to a given depth.
+// A ply is one placement of the drawn tile followed by every way the dragons
+// drawn after it can land, so the tree has both move and chance branches.
+// Leaves are the states exactly at the requested depth, games that end
+// earlier are counted as wins and losses on the way.
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_set>
+#include <vector>
+
+#include "board.hpp"
+#include "game.hpp"
+#include "tile.hpp"
+#include "trace.hpp"
+#include "worker_pool.hpp"
+
+namespace {
+// Board tiles, drawn tile, equipment count, pile size and result flags. The
+// valid moves and the pile contents follow from these for a fixed seed.
+using PositionKey = std::array<uint8_t, Board::m_board_size + 5>;
+
+struct PositionKeyHash {
+  size_t operator()(const PositionKey &key) const {
+    // FNV-1a
+    uint64_t hash{14695981039346656037ull};
+    for (auto byte : key) {
+      hash ^= byte;
+      hash *= 1099511628211ull;
+    }
+    return hash;
+  }
+};
+
+// Unique positions for one depth, split into shards so threads rarely wait
+// on the same lock
+class PositionSet {
+public:
+  static constexpr size_t m_shard_count = 64;
+
+private:
+  struct Shard {
+    std::mutex m_mutex;
+    std::unordered_set<PositionKey, PositionKeyHash> m_keys;
+  };
+  std::array<Shard, m_shard_count> m_shards;
+
+public:
+  void insert(const PositionKey &key) {
+    auto &shard = m_shards.at(PositionKeyHash{}(key) % m_shard_count);
+    std::lock_guard lock{shard.m_mutex};
+    shard.m_keys.insert(key);
+  }
+
+  size_t size() {
+    size_t total{0};
+    for (auto &shard : m_shards)
+      total += shard.m_keys.size();
+    return total;
+  }
+};
+
+struct PerftCounts {
+  uint64_t m_leaves{0};
+  uint64_t m_wins{0};
+  uint64_t m_losses{0};
+  uint64_t m_visited{0};
+
+  PerftCounts &operator+=(const PerftCounts &other) {
+    m_leaves += other.m_leaves;
+    m_wins += other.m_wins;
+    m_losses += other.m_losses;
+    m_visited += other.m_visited;
+    return *this;
+  }
+};
+
+struct Perft {
+  int m_depth{1};
+  // One set per ply, only used in hash mode
+  std::vector<PositionSet> *m_unique{nullptr};
+  // Nodes at this ply are collected for the threads instead of searched
+  int m_split_ply{-1};
+  std::vector<std::pair<Game, int>> *m_tasks{nullptr};
+
+  PositionKey key(const Game &game) const {
+    PositionKey key{};
+    for (uint8_t y{0}; y < Board::m_board_height; ++y) {
+      for (uint8_t x{0}; x < Board::m_board_width; ++x) {
+        key.at((y * Board::m_board_width) + x) =
+            game.board.get_tile(x, y).packed();
+      }
+    }
+    auto *extra = key.data() + Board::m_board_size;
+    extra[0] = game.m_next_tile.packed();
+    extra[1] = game.m_eq_count;
+    extra[2] = game.board.m_draw_pile.size();
+    extra[3] = game.m_game_won;
+    extra[4] = game.m_game_over;
+    return key;
+  }
+};
+
+// Per thread search state. Children are copied into one reused Game per
+// recursion level, copy assignment keeps the vectors' storage so the search
+// doesn't allocate once it has been down the tree once. A deque keeps the
+// games of the upper levels in place while deeper ones are added.
+struct PerftSearch {
+  const Perft &m_perft;
+  PerftCounts m_counts{};
+  std::deque<Game> m_scratch{};
+
+  Game &scratch(size_t level) {
+    if (m_scratch.size() <= level)
+      m_scratch.resize(level + 1);
+    return m_scratch[level];
+  }
+
+  void node(const Game &game, int ply, size_t level) {
+    m_counts.m_visited++;
+    if (m_perft.m_unique)
+      m_perft.m_unique->at(ply).insert(m_perft.key(game));
+
+    if (ply == m_perft.m_depth) {
+      m_counts.m_leaves++;
+      if (game.m_game_won)
+        m_counts.m_wins++;
+      else if (game.m_game_over)
+        m_counts.m_losses++;
+      return;
+    }
+
+    if (game.is_finished()) {
+      if (game.m_game_won)
+        m_counts.m_wins++;
+      else
+        m_counts.m_losses++;
+      return;
+    }
+
+    if (ply == m_perft.m_split_ply) {
+      m_perft.m_tasks->emplace_back(game, ply);
+      return;
+    }
+
+    Game::Placements placements;
+    const auto count = game.legal_placements(placements);
+    for (size_t i{0}; i < count; ++i) {
+      const auto &placement = placements.at(i);
+      auto &child = scratch(level);
+      child = game;
+      for (uint8_t r{0}; r < placement.rotation; ++r)
+        child.m_next_tile.rotate();
+      child.place_next_tile(placement.x, placement.y);
+
+      if (child.m_game_won)
+        node(child, ply + 1, level + 1);
+      else
+        dragons(child, ply + 1, level + 1);
+    }
+  }
+
+  // Chance branches, every tile a dragon can land on is one outcome
+  void dragons(Game &game, int ply, size_t level) {
+    if (game.m_next_tile.m_type != TileType::Dragon) {
+      game.finish_turn();
+      node(game, ply, level);
+      return;
+    }
+
+    for (uint8_t y{1}; y < Board::m_board_height - 1; ++y) {
+      for (uint8_t x{0}; x < Board::m_board_width; ++x) {
+        if (game.board.get_tile(x, y).m_type == TileType::Dragon)
+          continue;
+        auto &child = scratch(level);
+        child = game;
+        child.land_dragon(x, y);
+        dragons(child, ply, level + 1);
+      }
+    }
+  }
+};
+
+int usage(const char *name) {
+  fprintf(stderr,
+          "Usage: %s [--seed N] [--depth N] [--threads N] [--split N] "
+          "[--hash]\n",
+          name);
+  return 1;
+}
+} // namespace
+
+int main(int argc, char **argv) {
+  uint32_t seed{1};
+  int max_depth{3};
+  unsigned thread_count{0};
+  int split_ply{2};
+  bool hash_mode{false};
+
+  for (int i{1}; i < argc; ++i) {
+    const std::string_view arg{argv[i]};
+    const bool has_value = i + 1 < argc;
+    if ((arg == "--seed") && has_value)
+      seed = std::strtoul(argv[++i], nullptr, 10);
+    else if ((arg == "--depth") && has_value)
+      max_depth = std::atoi(argv[++i]);
+    else if ((arg == "--threads") && has_value)
+      thread_count = std::atoi(argv[++i]);
+    else if ((arg == "--split") && has_value)
+      split_ply = std::atoi(argv[++i]);
+    else if (arg == "--hash")
+      hash_mode = true;
+    else
+      return usage(argv[0]);
+  }
+  if (max_depth < 1)
+    return usage(argv[0]);
+
+  trace_set_thread_name("main");
+  WorkerPool pool{thread_count};
+
+  Game root;
+  root.m_rng.seed(seed);
+  root.new_game();
+
+  printf("seed %u, %u threads%s\n", seed, pool.size(),
+         hash_mode ? ", counting unique positions" : "");
+  printf("%5s %14s %12s %12s %14s %10s %12s\n", "depth", "leaves", "wins",
+         "losses", "unique", "seconds", "nodes/s");
+
+  for (int depth{1}; depth <= max_depth; ++depth) {
+    const auto start = std::chrono::steady_clock::now();
+
+    std::vector<PositionSet> unique(hash_mode ? depth + 1 : 0);
+    std::vector<std::pair<Game, int>> tasks;
+
+    // Shallow part of the tree is searched here, the subtrees below the
+    // split ply are handed to the pool. There are far more subtrees than
+    // threads and each thread claims the next one as soon as it's idle,
+    // which keeps the cores busy however uneven the subtrees are.
+    Perft perft{depth, hash_mode ? &unique : nullptr,
+                std::min(split_ply, depth), &tasks};
+    PerftSearch shallow{perft};
+    shallow.node(root, 0, 0);
+    PerftCounts total = shallow.m_counts;
+
+    std::vector<PerftCounts> results(tasks.size());
+    perft.m_split_ply = -1;
+    auto job = [&perft, &tasks, &results](size_t begin, size_t end) {
+      PerftSearch search{perft};
+      for (size_t i{begin}; i < end; ++i) {
+        TRACE_ZONE("perft subtree");
+        auto &[game, ply] = tasks.at(i);
+        search.m_counts = PerftCounts{};
+        search.node(game, ply, 0);
+        // The split node was already counted while collecting it
+        search.m_counts.m_visited--;
+        results.at(i) = search.m_counts;
+      }
+    };
+    pool.parallel_for(tasks.size(), 1, job);
+    for (auto &result : results)
+      total += result;
+
+    const std::chrono::duration<double> elapsed =
+        std::chrono::steady_clock::now() - start;
+    const auto unique_count =
+        hash_mode ? std::to_string(unique.at(depth).size()) : "-";
+    printf("%5d %14llu %12llu %12llu %14s %10.3f %12.0f\n", depth,
+           static_cast<unsigned long long>(total.m_leaves),
+           static_cast<unsigned long long>(total.m_wins),
+           static_cast<unsigned long long>(total.m_losses),
+           unique_count.c_str(), elapsed.count(),
+           total.m_visited / std::max(elapsed.count(), 1e-9));
+  }
+
+  return 0;
+}
@@ -0,0 +1,222 @@
+// Plays two policies against each other on the same deals until a
+// sequential probability ratio test can tell which hypothesis holds.
+// Both games of a pair start from one seed, so both sides get the same draw
+// pile and equipment and start from the same dragon roll stream. Rolls are
+// only guaranteed to match until a dragon lands on a Dragon tile on one
+// board and not the other: that roll is redone, and from then on the sides
+// see different rolls. This is rare, so pairing still removes most of the
+// luck of the deal. Pairs that both sides win or both lose say nothing about
+// which policy is stronger, only the split pairs feed the test: H0 is that
+// A wins half of them, H1 that A wins at least --p1 of them.
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <string_view>
+#include <vector>
+
+#include "game.hpp"
+#include "ntuple.hpp"
+#include "policy.hpp"
+#include "random.hpp"
+#include "sprt.hpp"
+#include "trace.hpp"
+#include "worker_pool.hpp"
+
+namespace {
+// The tables are large, only built when an ntuple policy plays
+std::unique_ptr<NTupleEvaluator> evaluator;
+
+bool ntuple_policy(const Game &game, Rng &rng, Placement &out) {
+  return evaluator->best_placement(game, rng, out);
+}
+
+struct NamedPolicy {
+  const char *m_name;
+  Policy m_policy;
+};
+
+constexpr std::array<NamedPolicy, 3> policies{{
+    {"random", random_policy},
+    {"greedy", greedy_policy},
+    {"ntuple", ntuple_policy},
+}};
+
+Policy find_policy(std::string_view name) {
+  for (const auto &policy : policies) {
+    if (name == policy.m_name)
+      return policy.m_policy;
+  }
+  return nullptr;
+}
+
+struct PairResult {
+  bool m_a_won{false};
+  bool m_b_won{false};
+};
+
+PairResult play_pair(Policy a, Policy b, uint32_t seed) {
+  Game deal;
+  deal.m_rng.seed(seed);
+  deal.new_game();
+
+  // Same policy rng on both sides too, a policy against itself makes the
+  // same moves and never splits
+  Game game_a = deal;
+  Game game_b = deal;
+  Rng rng_a{seed};
+  Rng rng_b{seed};
+  return PairResult{play_game(game_a, a, rng_a), play_game(game_b, b, rng_b)};
+}
+
+struct Totals {
+  uint64_t m_pairs{0};
+  uint64_t m_a_wins{0};
+  uint64_t m_b_wins{0};
+  uint64_t m_a_only{0};
+  uint64_t m_b_only{0};
+};
+
+int usage(const char *name) {
+  fprintf(stderr,
+          "Usage: %s [--a policy] [--b policy] [--seed N] [--p1 X] "
+          "[--alpha X] [--beta X] [--max-pairs N] [--threads N] "
+          "[--weights file]\n"
+          "Policies:",
+          name);
+  for (const auto &policy : policies)
+    fprintf(stderr, " %s", policy.m_name);
+  fprintf(stderr, "\n");
+  return 1;
+}
+} // namespace
+
+int main(int argc, char **argv) {
+  const char *name_a{"greedy"};
+  const char *name_b{"random"};
+  uint32_t seed{1};
+  double p1{0.6};
+  double alpha{0.05};
+  double beta{0.05};
+  uint64_t max_pairs{1'000'000};
+  unsigned thread_count{0};
+  const char *weights_path{"ntuple.weights"};
+
+  for (int i{1}; i < argc; ++i) {
+    const std::string_view arg{argv[i]};
+    const bool has_value = i + 1 < argc;
+    if ((arg == "--a") && has_value)
+      name_a = argv[++i];
+    else if ((arg == "--b") && has_value)
+      name_b = argv[++i];
+    else if ((arg == "--seed") && has_value)
+      seed = std::strtoul(argv[++i], nullptr, 10);
+    else if ((arg == "--p1") && has_value)
+      p1 = std::strtod(argv[++i], nullptr);
+    else if ((arg == "--alpha") && has_value)
+      alpha = std::strtod(argv[++i], nullptr);
+    else if ((arg == "--beta") && has_value)
+      beta = std::strtod(argv[++i], nullptr);
+    else if ((arg == "--max-pairs") && has_value)
+      max_pairs = std::strtoull(argv[++i], nullptr, 10);
+    else if ((arg == "--threads") && has_value)
+      thread_count = std::atoi(argv[++i]);
+    else if ((arg == "--weights") && has_value)
+      weights_path = argv[++i];
+    else
+      return usage(argv[0]);
+  }
+
+  const Policy policy_a = find_policy(name_a);
+  const Policy policy_b = find_policy(name_b);
+  if (!policy_a || !policy_b || (p1 <= 0.5) || (p1 >= 1.0) ||
+      (alpha <= 0.0) || (alpha >= 1.0) || (beta <= 0.0) || (beta >= 1.0))
+    return usage(argv[0]);
+  if ((policy_a == ntuple_policy) || (policy_b == ntuple_policy)) {
+    evaluator = std::make_unique<NTupleEvaluator>();
+    if (!evaluator->load(weights_path)) {
+      fprintf(stderr, "Couldn't load weights from %s\n", weights_path);
+      return 1;
+    }
+  }
+
+  trace_set_thread_name("main");
+  WorkerPool pool{thread_count};
+  Sprt sprt{p1, alpha, beta};
+  Totals totals;
+  Verdict verdict{Verdict::Undecided};
+
+  printf("A %s against B %s from seed %u, H1: A wins %.0f%% of split pairs, "
+         "%u threads\n",
+         name_a, name_b, seed, p1 * 100.0, pool.size());
+  const auto start = std::chrono::steady_clock::now();
+
+  // Pairs are played a batch at a time and folded in seed order, so where
+  // the test stops doesn't depend on the thread count
+  std::vector<PairResult> results(64 * pool.size());
+  while ((verdict == Verdict::Undecided) && (totals.m_pairs < max_pairs)) {
+    const uint64_t first = totals.m_pairs;
+    const size_t count = std::min<uint64_t>(results.size(), max_pairs - first);
+    auto job = [&](size_t begin, size_t end) {
+      for (size_t i{begin}; i < end; ++i)
+        results.at(i) = play_pair(policy_a, policy_b, seed + first + i);
+    };
+    pool.parallel_for(count, 1, job);
+
+    for (size_t i{0}; (i < count) && (verdict == Verdict::Undecided); ++i) {
+      const auto &result = results.at(i);
+      totals.m_pairs++;
+      totals.m_a_wins += result.m_a_won;
+      totals.m_b_wins += result.m_b_won;
+      if (result.m_a_won != result.m_b_won) {
+        totals.m_a_only += result.m_a_won;
+        totals.m_b_only += result.m_b_won;
+        verdict = sprt.add(result.m_a_won);
+      }
+    }
+  }
+
+  const std::chrono::duration<double> elapsed =
+      std::chrono::steady_clock::now() - start;
+  const double n = totals.m_pairs;
+  const double rate_a = totals.m_a_wins / n;
+  const double rate_b = totals.m_b_wins / n;
+  // Variance of the win rate difference per pair, paired and as if the two
+  // sides had been dealt separately
+  const double split = (totals.m_a_only + totals.m_b_only) / n;
+  const double mean = rate_a - rate_b;
+  const double paired = split - (mean * mean);
+  const double unpaired = (rate_a * (1.0 - rate_a)) + (rate_b * (1.0 - rate_b));
+
+  printf("%llu pairs in %.2f s, A won %.2f%%, B won %.2f%%, split pairs "
+         "A %llu B %llu\n",
+         static_cast<unsigned long long>(totals.m_pairs), elapsed.count(),
+         rate_a * 100.0, rate_b * 100.0,
+         static_cast<unsigned long long>(totals.m_a_only),
+         static_cast<unsigned long long>(totals.m_b_only));
+  printf("Win rate difference %.2f%% +- %.2f%%, pairing cut the variance "
+         "%.1fx\n",
+         mean * 100.0, 196.0 * std::sqrt(paired / n),
+         paired > 0.0 ? unpaired / paired : 0.0);
+  printf("LLR %.3f, bounds [%.3f, %.3f]\n", sprt.llr(), sprt.lower(),
+         sprt.upper());
+
+  switch (verdict) {
+  case Verdict::AcceptH1:
+    printf("H1 accepted: A is stronger than B\n");
+    return 0;
+  case Verdict::AcceptH0:
+    printf("H0 accepted: A is not stronger than B\n");
+    return 0;
+  case Verdict::Undecided:
+    printf("Undecided after %llu pairs\n",
+           static_cast<unsigned long long>(totals.m_pairs));
+    return 2;
+  }
+  return 2;
+}